@@ -0,0 +1,742 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "broadcast_ring.hpp"
+#include "byte_ring.hpp"
+#include "circular_queue.hpp"
+#include "growable_circular_queue.hpp"
+#include "mpmc_circular_queue.hpp"
+#include "multi_lane_queue.hpp"
+#include "queue_snapshot.hpp"
+#include "queue_stats.hpp"
+#include "ring_reductions.hpp"
+#include "sharded_circular_queue.hpp"
+#include "soa_circular_queue.hpp"
+#include "spsc_circular_queue.hpp"
+#include "timed_circular_queue.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace {
+
+    /**
+     * @brief Trivially copyable element of a fixed size.
+     */
+    template<std::size_t Bytes>
+    struct payload {
+        unsigned char bytes[Bytes];
+    };
+
+    /**
+     * @brief Destroys and frees an object created by make_aligned.
+     */
+    template<typename T>
+    struct aligned_delete {
+        void operator()(T *object) const {
+            object->~T();
+            std::free(object);
+        }
+    };
+
+    template<typename T>
+    using aligned_ptr = std::unique_ptr<T, aligned_delete<T>>;
+
+    /**
+     * @brief Creates an object on the heap at its full alignment.
+     *
+     * The concurrent queues align their members to cache lines, which plain
+     * new does not honour before C++17.
+     */
+    template<typename T, typename... Args>
+    aligned_ptr<T> make_aligned(Args &&... args) {
+        const std::size_t alignment = alignof(T) < sizeof(void *) ? sizeof(void *) : alignof(T);
+        void *raw = nullptr;
+        if (posix_memalign(&raw, alignment, sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        try {
+            return aligned_ptr<T>(::new(raw) T(std::forward<Args>(args)...));
+        } catch (...) {
+            std::free(raw);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Working-set sizes aimed at L1, L2, the last-level cache and main memory.
+     */
+    const std::vector<std::int64_t> footprints = {16 << 10, 512 << 10, 16 << 20, 256 << 20};
+
+    /**
+     * @brief Registers one argument per footprint, expressed as a capacity in elements.
+     */
+    template<typename T>
+    void capacities(benchmark::internal::Benchmark *bench) {
+        for (const std::int64_t bytes : footprints) {
+            bench->Arg(std::max<std::int64_t>(1, bytes / static_cast<std::int64_t>(sizeof(T))));
+        }
+    }
+
+    /**
+     * @brief Reports latency percentiles of the collected samples as benchmark counters.
+     */
+    void report_percentiles(benchmark::State &state, std::vector<double> &samples) {
+        if (samples.empty()) {
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        const auto at = [&](double q) {
+            return samples[static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1))];
+        };
+        state.counters["p50_ns"] = at(0.50);
+        state.counters["p99_ns"] = at(0.99);
+        state.counters["p999_ns"] = at(0.999);
+    }
+
+}
+
+/**
+ * Steady-state enqueue/dequeue pairs on a half-full circular_queue.
+ */
+template<typename T>
+void BM_circular_queue_enqueue_dequeue(benchmark::State &state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    circular_queue<T> queue(capacity);
+    const T value{};
+    while (queue.get_size() < capacity / 2 + 1) {
+        queue.enqueue(value);
+    }
+
+    for (auto _ : state) {
+        queue.enqueue(value);
+        benchmark::DoNotOptimize(queue.dequeue());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    state.SetBytesProcessed(state.iterations() * 2 * static_cast<std::int64_t>(sizeof(T)));
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_enqueue_dequeue, payload<4>)->Apply(capacities<payload<4>>);
+BENCHMARK_TEMPLATE(BM_circular_queue_enqueue_dequeue, payload<64>)->Apply(capacities<payload<64>>);
+BENCHMARK_TEMPLATE(BM_circular_queue_enqueue_dequeue, payload<512>)->Apply(capacities<payload<512>>);
+BENCHMARK_TEMPLATE(BM_circular_queue_enqueue_dequeue, payload<4096>)->Apply(capacities<payload<4096>>);
+
+/**
+ * Enqueue into a full circular_queue, overwriting the oldest element every time.
+ */
+template<typename T>
+void BM_circular_queue_overwrite(benchmark::State &state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    circular_queue<T> queue(capacity);
+    const T value{};
+    while (!queue.is_full()) {
+        queue.enqueue(value);
+    }
+
+    for (auto _ : state) {
+        queue.enqueue(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_overwrite, payload<4>)->Apply(capacities<payload<4>>);
+BENCHMARK_TEMPLATE(BM_circular_queue_overwrite, payload<64>)->Apply(capacities<payload<64>>);
+
+/**
+ * Cost of a logger policy on enqueue/dequeue pairs: no_log against the stats_log counters, with and without sampling.
+ */
+template<typename Logger>
+void BM_circular_queue_logger_overhead(benchmark::State &state) {
+    circular_queue<std::int64_t, Logger> queue(1024);
+    for (std::int64_t i = 0; i < 512; ++i) {
+        queue.enqueue(i);
+    }
+
+    std::int64_t next = 0;
+    for (auto _ : state) {
+        queue.enqueue(next++);
+        benchmark::DoNotOptimize(queue.dequeue());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_logger_overhead, no_log);
+BENCHMARK_TEMPLATE(BM_circular_queue_logger_overhead, stats_log<>);
+BENCHMARK_TEMPLATE(BM_circular_queue_logger_overhead, stats_log<64>);
+
+/**
+ * One element delivered to three consumers, through one broadcast_ring or, as the baseline, three circular_queues.
+ */
+template<bool Broadcast>
+void BM_fan_out_3(benchmark::State &state) {
+    broadcast_ring<payload<64>, 3> ring(1024);
+    circular_queue<payload<64>> queues[3] = {circular_queue<payload<64>>(1024), circular_queue<payload<64>>(1024),
+                                             circular_queue<payload<64>>(1024)};
+    payload<64> value{};
+    payload<64> out;
+
+    for (auto _ : state) {
+        if (Broadcast) {
+            ring.try_enqueue(value);
+            for (std::size_t c = 0; c < 3; ++c) {
+                ring.try_dequeue(c, out);
+                benchmark::DoNotOptimize(out);
+            }
+        } else {
+            for (auto &queue : queues) {
+                queue.enqueue(value);
+            }
+            for (auto &queue : queues) {
+                out = queue.dequeue();
+                benchmark::DoNotOptimize(out);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_fan_out_3, false);
+BENCHMARK_TEMPLATE(BM_fan_out_3, true);
+
+/**
+ * Variable-length messages through a byte_ring, or through circular_queue<std::string> as the baseline.
+ */
+template<bool Inline>
+void BM_variable_records(benchmark::State &state) {
+    byte_ring ring(1 << 16);
+    circular_queue<std::string> queue(1024);
+    const std::string message(static_cast<std::size_t>(state.range(0)), 'x');
+    ring_span<const unsigned char> record;
+    std::string out;
+
+    for (auto _ : state) {
+        if (Inline) {
+            ring.try_enqueue(message.data(), message.size());
+            ring.read_peek(record);
+            benchmark::DoNotOptimize(record.data());
+            ring.read_release();
+        } else {
+            queue.enqueue(message);
+            out = queue.dequeue();
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_variable_records, false)->Arg(16)->Arg(200)->Arg(4000);
+BENCHMARK_TEMPLATE(BM_variable_records, true)->Arg(16)->Arg(200)->Arg(4000);
+
+/**
+ * Control and bulk traffic through one multi_lane_queue, where every eighth element goes to the high-priority lane.
+ */
+template<typename Schedule>
+void BM_multi_lane_queue_mixed(benchmark::State &state) {
+    multi_lane_queue<std::int64_t, 2, Schedule> queue(1024);
+    std::int64_t next = 0;
+    std::int64_t out = 0;
+
+    for (auto _ : state) {
+        for (int i = 0; i < 8; ++i, ++next) {
+            queue.enqueue((next & 7) == 0 ? 0 : 1, next);
+        }
+        for (int i = 0; i < 8; ++i) {
+            queue.try_dequeue(out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+
+BENCHMARK_TEMPLATE(BM_multi_lane_queue_mixed, strict_priority);
+BENCHMARK_TEMPLATE(BM_multi_lane_queue_mixed, weighted_round_robin);
+
+/**
+ * Bulk enqueue/dequeue of a batch through circular_queue.
+ */
+template<typename T>
+void BM_circular_queue_bulk(benchmark::State &state) {
+    const auto batch = static_cast<std::size_t>(state.range(0));
+    circular_queue<T> queue(batch * 4);
+    std::vector<T> in(batch), out(batch);
+    // Offset the ring so every batch straddles the wrap point now and then
+    queue.enqueue_bulk(in.data(), batch / 2 + 1);
+
+    for (auto _ : state) {
+        queue.enqueue_bulk(in.data(), batch);
+        benchmark::DoNotOptimize(queue.dequeue_bulk(out.data(), batch));
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * static_cast<std::int64_t>(batch));
+    state.SetBytesProcessed(state.iterations() * 2 * static_cast<std::int64_t>(batch * sizeof(T)));
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_bulk, payload<4>)->RangeMultiplier(8)->Range(8, 32768);
+BENCHMARK_TEMPLATE(BM_circular_queue_bulk, payload<64>)->RangeMultiplier(8)->Range(8, 32768);
+BENCHMARK_TEMPLATE(BM_circular_queue_bulk, payload<4096>)->RangeMultiplier(8)->Range(8, 512);
+
+/**
+ * Doubling the capacity of a full circular_queue.
+ */
+template<typename T>
+void BM_circular_queue_resize(benchmark::State &state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    const T value{};
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::unique_ptr<circular_queue<T>> queue(new circular_queue<T>(capacity));
+        while (!queue->is_full()) {
+            queue->enqueue(value);
+        }
+        state.ResumeTiming();
+
+        queue->resize(capacity * 2);
+        benchmark::DoNotOptimize(queue->get_capacity());
+
+        // Keep the destruction of the queue out of the measurement
+        state.PauseTiming();
+        queue.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(capacity));
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_resize, payload<4>)->Apply(capacities<payload<4>>);
+BENCHMARK_TEMPLATE(BM_circular_queue_resize, payload<64>)->Apply(capacities<payload<64>>);
+
+/**
+ * Per-enqueue latency while a growable_circular_queue grows from 1024 elements to the given size.
+ */
+template<typename T>
+void BM_growable_queue_fill(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const T value{};
+    std::vector<double> samples;
+    samples.reserve(count);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::unique_ptr<growable_circular_queue<T>> queue(new growable_circular_queue<T>(1024));
+        samples.clear();
+        state.ResumeTiming();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            queue->enqueue(value);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        state.PauseTiming();
+        queue.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+    report_percentiles(state, samples);
+    state.counters["max_ns"] = *std::max_element(samples.begin(), samples.end());
+}
+
+BENCHMARK_TEMPLATE(BM_growable_queue_fill, payload<64>)->Arg(1 << 16)->Arg(1 << 22);
+
+/**
+ * Summing a wrapped, full circular_queue with window_sum, against a plain loop over its iterators.
+ */
+template<typename T, bool Vectorized>
+void BM_circular_queue_window_sum(benchmark::State &state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    circular_queue<T> queue(capacity);
+    // Overfill by half so the live elements straddle the wrap point
+    for (std::size_t i = 0; i < capacity + capacity / 2; ++i) {
+        queue.enqueue(static_cast<T>(i & 0xff));
+    }
+
+    for (auto _ : state) {
+        T total{};
+        if (Vectorized) {
+            total = window_sum(queue);
+        } else {
+            for (const T &value : queue) {
+                total += value;
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(capacity));
+}
+
+BENCHMARK_TEMPLATE(BM_circular_queue_window_sum, float, true)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_circular_queue_window_sum, float, false)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_circular_queue_window_sum, std::int64_t, true)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_circular_queue_window_sum, std::int64_t, false)->RangeMultiplier(16)->Range(64, 1 << 20);
+
+/**
+ * Pushing into a full sliding_window and reading its sum, minimum and maximum.
+ */
+void BM_sliding_window_push(benchmark::State &state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    sliding_window<std::int64_t> window(capacity);
+    std::int64_t next = 0;
+    for (std::size_t i = 0; i < capacity; ++i) {
+        window.push(next++ % 1000);
+    }
+
+    for (auto _ : state) {
+        window.push(next++ % 1000);
+        benchmark::DoNotOptimize(window.sum() + window.min() + window.max());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_sliding_window_push)->Arg(1024)->Arg(1 << 20);
+
+/**
+ * Sum of one field of a full queue of ticks, stored as structs in circular_queue or as columns in soa_circular_queue.
+ */
+template<bool Columns>
+void BM_tick_price_sum(benchmark::State &state) {
+    struct tick {
+        float price;
+        std::int32_t size;
+        std::uint64_t timestamp;
+    };
+    const auto n = static_cast<std::size_t>(state.range(0));
+    circular_queue<tick> rows(n);
+    soa_circular_queue<float, std::int32_t, std::uint64_t> columns(n);
+    for (std::size_t i = 0; i < n + n / 3; ++i) {
+        rows.enqueue(tick{static_cast<float>(i & 0xFF), 1, i});
+        columns.enqueue(static_cast<float>(i & 0xFF), 1, i);
+    }
+
+    for (auto _ : state) {
+        float sum = 0;
+        if (Columns) {
+            sum = window_sum(columns.column<0>());
+        } else {
+            for (const tick &t : rows) {
+                sum += t.price;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_tick_price_sum, false)->RangeMultiplier(64)->Range(1024, 1 << 22);
+BENCHMARK_TEMPLATE(BM_tick_price_sum, true)->RangeMultiplier(64)->Range(1024, 1 << 22);
+
+/**
+ * A rate limiter's hot path: record an event, then evict those older than a window of state.range(0) ticks.
+ * The baseline is a std::deque of timestamps trimmed from the front.
+ */
+template<bool Timed>
+void BM_rate_limiter_window(benchmark::State &state) {
+    using clock = std::chrono::steady_clock;
+    const auto window = clock::duration(state.range(0));
+    timed_circular_queue<std::int64_t> timed(1 << 16);
+    std::deque<clock::time_point> baseline;
+    clock::time_point now{};
+
+    for (auto _ : state) {
+        now += clock::duration(1);
+        if (Timed) {
+            timed.push(1, now);
+            timed.evict_older_than(now - window);
+            benchmark::DoNotOptimize(timed.get_size());
+        } else {
+            baseline.push_back(now);
+            while (baseline.front() < now - window) {
+                baseline.pop_front();
+            }
+            benchmark::DoNotOptimize(baseline.size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_rate_limiter_window, false)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_rate_limiter_window, true)->Arg(64)->Arg(4096);
+
+/**
+ * Checkpoints a full, wrapped ring of state.range(0) 64-byte elements to an unlinked temporary file, truncated
+ * before every iteration. With state.range(1) set, each checkpoint ends with fdatasync, so it includes the disk
+ * write. The baseline copies the contents out with get_all_elements and writes the vector.
+ */
+template<bool Snapshot>
+void BM_checkpoint(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    circular_queue<payload<64>> queue(n);
+    for (std::size_t i = 0; i < n + n / 3; ++i) {
+        queue.enqueue(payload<64>{});
+    }
+    std::FILE *file = std::tmpfile();
+    if (file == nullptr) {
+        state.SkipWithError("Cannot create a temporary file");
+        return;
+    }
+    const int fd = fileno(file);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        benchmark::DoNotOptimize(ftruncate(fd, 0));
+        benchmark::DoNotOptimize(lseek(fd, 0, SEEK_SET));
+        state.ResumeTiming();
+
+        if (Snapshot) {
+            queue.snapshot(fd_writer{fd});
+        } else {
+            const std::vector<payload<64>> elements = queue.get_all_elements();
+            const ring_span<const unsigned char> chunk(reinterpret_cast<const unsigned char *>(elements.data()),
+                                                       elements.size() * sizeof(payload<64>));
+            fd_writer{fd}(&chunk, 1);
+        }
+        if (state.range(1) != 0) {
+            benchmark::DoNotOptimize(fdatasync(fd));
+        }
+    }
+    std::fclose(file);
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(sizeof(payload<64>)));
+}
+
+BENCHMARK_TEMPLATE(BM_checkpoint, false)->ArgsProduct({{1 << 10, 1 << 20}, {0, 1}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_checkpoint, true)->ArgsProduct({{1 << 10, 1 << 20}, {0, 1}})->UseRealTime();
+
+/**
+ * Producer/consumer throughput through spsc_circular_queue, one thread on each side.
+ */
+template<typename T>
+void BM_spsc_throughput(benchmark::State &state) {
+    static aligned_ptr<spsc_circular_queue<T>> queue;
+    if (state.thread_index() == 0) {
+        queue = make_aligned<spsc_circular_queue<T>>(static_cast<std::size_t>(state.range(0)));
+    }
+
+    T value{};
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            while (!queue->try_enqueue(value)) {
+            }
+        } else {
+            while (!queue->try_dequeue(value)) {
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        queue.reset();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_spsc_throughput, payload<4>)->Apply(capacities<payload<4>>)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_spsc_throughput, payload<64>)->Apply(capacities<payload<64>>)->Threads(2)->UseRealTime();
+
+/**
+ * Round-trip latency between two threads over a pair of spsc_circular_queues.
+ */
+void BM_spsc_round_trip_latency(benchmark::State &state) {
+    spsc_circular_queue<std::int64_t> ping(1024), pong(1024);
+    std::atomic<bool> done{false};
+
+    std::thread echo([&] {
+        std::int64_t value;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (ping.try_dequeue(value)) {
+                while (!pong.try_enqueue(value)) {
+                }
+            }
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(1 << 20);
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        while (!ping.try_enqueue(value)) {
+        }
+        while (!pong.try_dequeue(value)) {
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (samples.size() < samples.capacity()) {
+            samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    done.store(true, std::memory_order_relaxed);
+    echo.join();
+    report_percentiles(state, samples);
+}
+
+BENCHMARK(BM_spsc_round_trip_latency)->UseRealTime();
+
+/**
+ * Shared mpmc_circular_queue under increasing thread counts; every thread enqueues and dequeues.
+ */
+void BM_mpmc_throughput(benchmark::State &state) {
+    static aligned_ptr<mpmc_circular_queue<std::int64_t>> queue;
+    if (state.thread_index() == 0) {
+        queue = make_aligned<mpmc_circular_queue<std::int64_t>>(static_cast<std::size_t>(state.range(0)));
+    }
+
+    std::int64_t value = state.thread_index();
+    for (auto _ : state) {
+        while (!queue->try_enqueue(value)) {
+        }
+        while (!queue->try_dequeue(value)) {
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+
+    if (state.thread_index() == 0) {
+        queue.reset();
+    }
+}
+
+BENCHMARK(BM_mpmc_throughput)->Arg(1024)->Arg(1 << 20)
+    ->ThreadRange(1, static_cast<int>(std::max(2u, std::thread::hardware_concurrency())))->UseRealTime();
+
+/**
+ * Shared sharded_circular_queue with one shard per thread; every thread enqueues and dequeues, as in BM_mpmc_throughput.
+ */
+void BM_sharded_throughput(benchmark::State &state) {
+    static std::unique_ptr<sharded_circular_queue<std::int64_t>> queue;
+    if (state.thread_index() == 0) {
+        queue.reset(new sharded_circular_queue<std::int64_t>(1024, static_cast<std::size_t>(state.threads())));
+    }
+    sharded_circular_queue<std::int64_t>::bind_thread_slot(static_cast<std::size_t>(state.thread_index()));
+
+    std::int64_t value = state.thread_index();
+    for (auto _ : state) {
+        while (!queue->try_enqueue(value)) {
+        }
+        while (!queue->try_dequeue(value)) {
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+
+    if (state.thread_index() == 0) {
+        queue.reset();
+    }
+}
+
+BENCHMARK(BM_sharded_throughput)
+    ->ThreadRange(1, static_cast<int>(std::max(2u, std::thread::hardware_concurrency())))->UseRealTime();
+
+/**
+ * Bulk transfer through mpmc_circular_queue under increasing thread counts.
+ */
+void BM_mpmc_bulk_throughput(benchmark::State &state) {
+    static aligned_ptr<mpmc_circular_queue<std::int64_t>> queue;
+    if (state.thread_index() == 0) {
+        queue = make_aligned<mpmc_circular_queue<std::int64_t>>(1 << 16);
+    }
+
+    const auto batch = static_cast<std::size_t>(state.range(0));
+    std::vector<std::int64_t> in(batch), out(batch);
+    for (auto _ : state) {
+        std::size_t sent = 0, received = 0;
+        while (sent < batch) {
+            sent += queue->try_enqueue_bulk(in.data() + sent, batch - sent);
+        }
+        while (received < batch) {
+            received += queue->try_dequeue_bulk(out.data() + received, batch - received);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * static_cast<std::int64_t>(batch));
+
+    if (state.thread_index() == 0) {
+        queue.reset();
+    }
+}
+
+BENCHMARK(BM_mpmc_bulk_throughput)->Arg(16)->Arg(256)
+    ->ThreadRange(1, static_cast<int>(std::max(2u, std::thread::hardware_concurrency())))->UseRealTime();
+
+/**
+ * Round-trip latency between two threads over a pair of mpmc_circular_queues.
+ */
+void BM_mpmc_round_trip_latency(benchmark::State &state) {
+    mpmc_circular_queue<std::int64_t> ping(1024), pong(1024);
+    std::atomic<bool> done{false};
+
+    std::thread echo([&] {
+        std::int64_t value;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (ping.try_dequeue(value)) {
+                while (!pong.try_enqueue(value)) {
+                }
+            }
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(1 << 20);
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        while (!ping.try_enqueue(value)) {
+        }
+        while (!pong.try_dequeue(value)) {
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (samples.size() < samples.capacity()) {
+            samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    done.store(true, std::memory_order_relaxed);
+    echo.join();
+    report_percentiles(state, samples);
+}
+
+BENCHMARK(BM_mpmc_round_trip_latency)->UseRealTime();
+
+/**
+ * work_stealing_deque with thread 0 as the owner, pushing batches and popping what is left, and the rest as thieves.
+ */
+void BM_work_stealing_deque(benchmark::State &state) {
+    static aligned_ptr<work_stealing_deque<std::int64_t>> deque;
+    if (state.thread_index() == 0) {
+        deque = make_aligned<work_stealing_deque<std::int64_t>>(256);
+    }
+
+    std::int64_t value = 0;
+    std::int64_t taken = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            for (int i = 0; i < 32; ++i) {
+                deque->push(value++);
+            }
+            while (deque->try_pop(value)) {
+                ++taken;
+            }
+        } else if (deque->try_steal(value)) {
+            ++taken;
+        }
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(taken);
+
+    if (state.thread_index() == 0) {
+        deque.reset();
+    }
+}
+
+BENCHMARK(BM_work_stealing_deque)
+    ->ThreadRange(1, static_cast<int>(std::max(2u, std::thread::hardware_concurrency())))->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,390 @@
+#pragma once
+
+#include "queue_detail.hpp"
+
+#if CQUEUE_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#include "mpmc_circular_queue.hpp"
+
+/**
+ * @brief Resumption policy that resumes a woken coroutine on the waking thread, inside the call that woke it.
+ */
+struct inline_resume {
+    void operator()(std::coroutine_handle<> handle) const {
+        handle.resume();
+    }
+};
+
+/**
+ * @brief A concurrent queue with awaitable enqueue and dequeue for C++20 coroutines.
+ *
+ * co_await async_dequeue() completes at once when an element is available and
+ * otherwise suspends the coroutine until one is; co_await async_enqueue(v)
+ * does the same while the queue is full, which gives backpressure across any
+ * number of coroutines without a thread per waiter. The try_ operations never
+ * suspend and can be mixed freely with the awaitables.
+ *
+ * A suspended coroutine is linked into a FIFO waiter list through its
+ * awaiter, which lives in the coroutine frame, so suspending allocates
+ * nothing. Whoever frees a slot or adds an element moves elements on behalf
+ * of the waiters, oldest first, for as long as the queue accepts them, and
+ * only then resumes them, so a resumed coroutine always has its result and
+ * never has to suspend again. The fast paths stay
+ * lock-free: they check for waiters with one fence and one load, and the
+ * waiter lists are guarded by a mutex that is only taken when a waiter may be
+ * parked.
+ *
+ * The Resume policy is called with each woken coroutine after the waker has
+ * released the lock. The default resumes it inline; with an event loop, pass
+ * a policy that posts the handle to the loop instead, for example as an
+ * io_uring message or a ready-queue entry, so the coroutine runs on its
+ * executor and wake-ups do not nest on the waker's stack.
+ *
+ * Queue must support try_enqueue and try_dequeue from any thread at once:
+ * mpmc_circular_queue (the default) or sharded_circular_queue. The queue must
+ * not be destroyed while coroutines are suspended on it.
+ *
+ * @tparam T The type of elements in the queue; must be default constructible.
+ * @tparam Queue The underlying concurrent queue.
+ * @tparam Resume The function object that resumes woken coroutines.
+ */
+template<typename T, typename Queue = mpmc_circular_queue<T>, typename Resume = inline_resume>
+class async_queue {
+
+public:
+
+    class dequeue_awaiter;
+    class enqueue_awaiter;
+
+private:
+
+    /**
+     * @brief A FIFO list of suspended awaiters, linked through the awaiters themselves.
+     */
+    template<typename Awaiter>
+    struct waiter_list {
+        Awaiter *first{};   ///< Longest-waiting awaiter
+        Awaiter *last{};    ///< Most recent awaiter
+
+        void push(Awaiter *waiter) {
+            waiter->next = nullptr;
+            if (last != nullptr) {
+                last->next = waiter;
+            } else {
+                first = waiter;
+            }
+            last = waiter;
+        }
+
+        void pop() {
+            first = first->next;
+            if (first == nullptr) {
+                last = nullptr;
+            }
+        }
+    };
+
+    Queue queue;                                    ///< The underlying queue
+    Resume resume;                                  ///< Resumes woken coroutines
+    std::mutex lock;                                ///< Guards the waiter lists
+    waiter_list<dequeue_awaiter> consumers;         ///< Coroutines waiting for an element
+    waiter_list<enqueue_awaiter> producers;         ///< Coroutines waiting for a free slot
+    std::atomic<std::size_t> waiting_consumers{0};  ///< Length of consumers, readable without the lock
+    std::atomic<std::size_t> waiting_producers{0};  ///< Length of producers, readable without the lock
+
+public:
+
+    /**
+     * @brief The awaitable returned by async_dequeue; co_await yields the removed element.
+     */
+    class dequeue_awaiter {
+
+        friend class async_queue;
+
+        async_queue &owner;
+        dequeue_awaiter *next{};
+        std::coroutine_handle<> handle;
+        T value{};
+
+        explicit dequeue_awaiter(async_queue &owner)
+            : owner(owner) {
+        }
+
+    public:
+
+        dequeue_awaiter(const dequeue_awaiter &) = delete;
+        dequeue_awaiter &operator=(const dequeue_awaiter &) = delete;
+
+        bool await_ready() {
+            return owner.try_dequeue(value);
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return owner.park_consumer(*this);
+        }
+
+        T await_resume() {
+            return std::move(value);
+        }
+    };
+
+    /**
+     * @brief The awaitable returned by async_enqueue; co_await completes once the element is in the queue.
+     */
+    class enqueue_awaiter {
+
+        friend class async_queue;
+
+        async_queue &owner;
+        enqueue_awaiter *next{};
+        std::coroutine_handle<> handle;
+        T value;
+
+        enqueue_awaiter(async_queue &owner, T &&value)
+            : owner(owner), value(std::move(value)) {
+        }
+
+    public:
+
+        enqueue_awaiter(const enqueue_awaiter &) = delete;
+        enqueue_awaiter &operator=(const enqueue_awaiter &) = delete;
+
+        bool await_ready() {
+            return owner.try_enqueue(std::move(value));
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return owner.park_producer(*this);
+        }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    /**
+     * @brief Constructor that creates an empty queue.
+     *
+     * @param n The capacity passed to the underlying queue.
+     * @param resume The resumption policy.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit async_queue(std::size_t n, const Resume &resume = Resume())
+        : queue(n), resume(resume) {
+    }
+
+    async_queue(const async_queue &) = delete;
+    async_queue &operator=(const async_queue &) = delete;
+
+    /**
+     * @brief Returns an awaitable that removes the front element, suspending while the queue is empty.
+     *
+     * @return The awaitable; co_await it to get the element.
+     */
+    dequeue_awaiter async_dequeue() {
+        return dequeue_awaiter(*this);
+    }
+
+    /**
+     * @brief Returns an awaitable that adds an element, suspending while the queue is full.
+     *
+     * @param value The element to add; held by the awaitable until it is in the queue.
+     * @return The awaitable; co_await it to wait for the element to be added.
+     */
+    enqueue_awaiter async_enqueue(T value) {
+        return enqueue_awaiter(*this, std::move(value));
+    }
+
+    /**
+     * @brief Adds an element without suspending, waking a waiting consumer.
+     *
+     * @param value The element to add; left untouched if the queue is full.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(T &&value) {
+        if (!queue.try_enqueue(std::move(value))) {
+            return false;
+        }
+        wake_consumer();
+        return true;
+    }
+
+    /**
+     * @brief Copies an element into the queue without suspending, waking a waiting consumer.
+     *
+     * @param value The element to add.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(const T &value) {
+        if (!queue.try_enqueue(value)) {
+            return false;
+        }
+        wake_consumer();
+        return true;
+    }
+
+    /**
+     * @brief Removes the front element without suspending, waking a waiting producer.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool try_dequeue(T &out) {
+        if (!queue.try_dequeue(out)) {
+            return false;
+        }
+        wake_producer();
+        return true;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return queue.is_empty();
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in the queue.
+     *
+     * @return The current size of the queue, as a snapshot.
+     */
+    std::size_t get_size() const {
+        return queue.get_size();
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the underlying queue.
+     */
+    std::size_t get_capacity() const {
+        return queue.get_capacity();
+    }
+
+private:
+
+    /**
+     * @brief Parks a consumer unless an element turns up while it registers.
+     *
+     * @return True if the coroutine stays suspended, false if it got an element and continues at once.
+     */
+    bool park_consumer(dequeue_awaiter &waiter) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            // Registering before the retry pairs with the fence in wake_consumer: either the
+            // producer sees this waiter, or the retry sees the producer's element
+            waiting_consumers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!queue.try_dequeue(waiter.value)) {
+                consumers.push(&waiter);
+                return true;
+            }
+            waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        wake_producer();
+        return false;
+    }
+
+    /**
+     * @brief Parks a producer unless a slot frees up while it registers.
+     *
+     * @return True if the coroutine stays suspended, false if its element was added and it continues at once.
+     */
+    bool park_producer(enqueue_awaiter &waiter) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            waiting_producers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!queue.try_enqueue(std::move(waiter.value))) {
+                producers.push(&waiter);
+                return true;
+            }
+            waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        wake_consumer();
+        return false;
+    }
+
+    /**
+     * @brief Wakes waiting consumers after an element was added, if any are parked.
+     */
+    void wake_consumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers.load(std::memory_order_relaxed) != 0) {
+            serve_waiters();
+        }
+    }
+
+    /**
+     * @brief Wakes waiting producers after a slot was freed, if any are parked.
+     */
+    void wake_producer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers.load(std::memory_order_relaxed) != 0) {
+            serve_waiters();
+        }
+    }
+
+    /**
+     * @brief Serves the waiters in FIFO order for as long as the queue lets them make progress, then resumes them.
+     *
+     * One wake-up may have to serve several waiters: a concurrent queue can
+     * refuse an element whose slot is claimed but not yet published while
+     * later ones are ready, so the enqueue that publishes it must also hand
+     * over the ones behind it. Every element taken frees a slot for a waiting
+     * producer and every element added can go to a waiting consumer, so both
+     * lists are served until neither moves.
+     */
+    void serve_waiters() {
+        waiter_list<dequeue_awaiter> served_consumers;
+        waiter_list<enqueue_awaiter> served_producers;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            bool progress = true;
+            while (progress) {
+                progress = false;
+                // The element may already have been taken by a consumer on the fast path
+                while (consumers.first != nullptr && queue.try_dequeue(consumers.first->value)) {
+                    dequeue_awaiter *waiter = consumers.first;
+                    consumers.pop();
+                    waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+                    served_consumers.push(waiter);
+                    progress = true;
+                }
+                while (producers.first != nullptr && queue.try_enqueue(std::move(producers.first->value))) {
+                    enqueue_awaiter *waiter = producers.first;
+                    producers.pop();
+                    waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+                    served_producers.push(waiter);
+                    progress = true;
+                }
+            }
+        }
+        // A resumed coroutine may destroy its frame and the awaiter with it, so read next first
+        for (dequeue_awaiter *waiter = served_consumers.first; waiter != nullptr;) {
+            dequeue_awaiter *next = waiter->next;
+            resume(waiter->handle);
+            waiter = next;
+        }
+        for (enqueue_awaiter *waiter = served_producers.first; waiter != nullptr;) {
+            enqueue_awaiter *next = waiter->next;
+            resume(waiter->handle);
+            waiter = next;
+        }
+    }
+
+};
+
+#endif
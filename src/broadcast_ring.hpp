@@ -0,0 +1,353 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+/**
+ * @brief A single-producer ring that delivers every element to each of several consumers.
+ *
+ * The producer writes each element once. Every consumer has its own read
+ * cursor and sees the whole stream in order, so N stages can share one copy of
+ * the data instead of receiving one queue each. A slot is only reused after
+ * every consumer has moved past it: the producer is gated by the slowest
+ * cursor and rejects new elements while it is a full lap behind.
+ *
+ * As in the LMAX Disruptor, a consumer can depend on others, in which case it
+ * only sees the elements all of them have released. That orders stages (for
+ * example, business logic after journaling) without extra queues, and whatever
+ * an upstream consumer wrote before releasing an element is visible to its
+ * dependents. The producer then only has to check the consumers nothing
+ * depends on, because everyone else is ahead of them.
+ *
+ * Consumers read elements in place: try_dequeue copies one element out, and
+ * read_peek/read_release expose a batch without copying. Each consumer id must
+ * be used by one thread at a time, concurrently with the producer and the
+ * other consumers.
+ *
+ * The producer and every cursor sit on their own cache line, and each side
+ * caches the positions it last observed, so uncontended operations touch no
+ * shared line. As in mpmc_circular_queue, the constructor of T used by an
+ * enqueue must not throw.
+ *
+ * @tparam T The type of elements in the ring.
+ * @tparam Consumers The number of consumers (1 to 64), identified as 0 to Consumers - 1.
+ */
+template<typename T, std::size_t Consumers>
+class broadcast_ring {
+
+    static_assert(Consumers >= 1 && Consumers <= 64, "broadcast_ring supports 1 to 64 consumers");
+
+    /**
+     * @brief The read position and dependencies of one consumer.
+     */
+    struct alignas(cqueue_detail::cache_line_size) consumer_state {
+        std::atomic<std::size_t> cursor{0};     ///< Next position to read, published to the producer and dependents
+        std::size_t cached_limit{0};            ///< Consumer's last observed end of the readable range
+        std::uint64_t upstream{0};              ///< Bit i is set if this consumer waits for consumer i
+    };
+
+    // Read-only after construction; kept off the lines the positions bounce on
+    alignas(cqueue_detail::cache_line_size) T *arr{};               ///< Uninitialized slot storage
+    std::size_t capacity{}, mask{};                                 ///< Number of slots and index mask
+    std::uint64_t gating{};                                         ///< Bit i is set if no consumer waits for consumer i
+    std::allocator<T> allocator;                                    ///< Allocator for the storage
+
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> published{0};  ///< Next position to write
+    std::size_t cached_min{0};                                      ///< Producer's last observed slowest cursor
+
+    std::array<consumer_state, Consumers> consumers{};              ///< Per-consumer state
+
+public:
+
+    /**
+     * @brief Constructor that creates an empty ring whose consumers are independent.
+     *
+     * @param n The minimum number of elements the ring must hold; rounded up to a power of two.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit broadcast_ring(std::size_t n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        capacity = cqueue_detail::next_power_of_two(n);
+        mask = capacity - 1;
+        arr = allocator.allocate(capacity);
+        gating = Consumers == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << Consumers) - 1;
+    }
+
+    broadcast_ring(const broadcast_ring &) = delete;
+    broadcast_ring &operator=(const broadcast_ring &) = delete;
+
+    /**
+     * @brief Destroys the elements still in the ring and releases the storage.
+     *
+     * Must not run concurrently with the producer or any consumer.
+     */
+    ~broadcast_ring() {
+        // Every slot written so far still holds its latest element
+        const std::size_t end = published.load(std::memory_order_relaxed);
+        for (std::size_t pos = end < capacity ? 0 : end - capacity; pos != end; ++pos) {
+            arr[pos & mask].~T();
+        }
+        allocator.deallocate(arr, capacity);
+    }
+
+    /**
+     * @brief Makes a consumer see only the elements that the given consumers have released.
+     *
+     * A consumer may only depend on lower-numbered consumers, which rules out
+     * cycles. Dependencies are part of the setup and cannot change once the
+     * producer has started.
+     *
+     * @param consumer The dependent consumer.
+     * @param upstream The consumers it waits for; an empty list makes it independent again.
+     * @throws std::out_of_range if consumer is not less than Consumers.
+     * @throws std::invalid_argument if an upstream consumer is not lower-numbered than consumer.
+     * @throws std::logic_error if an element has already been enqueued.
+     */
+    void set_dependencies(std::size_t consumer, std::initializer_list<std::size_t> upstream) {
+        if (consumer >= Consumers) {
+            CQUEUE_THROW(std::out_of_range("Consumer out of range"));
+        }
+        if (published.load(std::memory_order_relaxed) != 0) {
+            CQUEUE_THROW(std::logic_error("Dependencies must be set before the first enqueue"));
+        }
+        std::uint64_t bits = 0;
+        for (const std::size_t u : upstream) {
+            if (u >= consumer) {
+                CQUEUE_THROW(std::invalid_argument("A consumer can only depend on lower-numbered consumers"));
+            }
+            bits |= std::uint64_t(1) << u;
+        }
+        consumers[consumer].upstream = bits;
+
+        gating = Consumers == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << Consumers) - 1;
+        for (const consumer_state &state : consumers) {
+            gating &= ~state.upstream;
+        }
+    }
+
+    /**
+     * @brief Adds an element for every consumer. Producer only.
+     *
+     * @param value The element to be added to the ring.
+     * @return True if the element was added, false if the slowest consumer is a full lap behind.
+     */
+    bool try_enqueue(const T &value) {
+        return try_emplace(value);
+    }
+
+    /**
+     * @brief Moves an element into the ring for every consumer. Producer only.
+     *
+     * @param value The element to be moved into the ring; left untouched if the ring is full.
+     * @return True if the element was added, false if the slowest consumer is a full lap behind.
+     */
+    bool try_enqueue(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place for every consumer. Producer only.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return True if the element was added, false if the slowest consumer is a full lap behind.
+     */
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        const std::size_t p = published.load(std::memory_order_relaxed);
+        if (p - cached_min == capacity) {
+            cached_min = slowest_cursor();
+            if (p - cached_min == capacity) {
+                return false;
+            }
+        }
+        T *slot = arr + (p & mask);
+        if (p >= capacity) {
+            slot->~T(); // Every consumer has moved past the previous lap's element
+        }
+        ::new(static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+        published.store(p + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Copies the next element of a consumer's stream and moves its cursor past it.
+     *
+     * @param consumer The reading consumer.
+     * @param out Receives a copy of the element.
+     * @return True if an element was read, false if none is available to this consumer.
+     * @throws std::out_of_range if consumer is not less than Consumers.
+     */
+    bool try_dequeue(std::size_t consumer, T &out) {
+        consumer_state &state = state_of(consumer);
+        const std::size_t pos = state.cursor.load(std::memory_order_relaxed);
+        if (pos == state.cached_limit) {
+            state.cached_limit = limit_of(state);
+            if (pos == state.cached_limit) {
+                return false;
+            }
+        }
+        out = arr[pos & mask];
+        state.cursor.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Exposes up to n elements of a consumer's stream for reading in place.
+     *
+     * The elements are returned as at most two contiguous spans, split at the
+     * wrap point, and stay valid until the consumer calls read_release.
+     *
+     * @param consumer The reading consumer.
+     * @param n The maximum number of elements to expose.
+     * @return The next elements, in order; their total size may be less than n.
+     * @throws std::out_of_range if consumer is not less than Consumers.
+     */
+    ring_span_pair<const T> read_peek(std::size_t consumer, std::size_t n) {
+        consumer_state &state = state_of(consumer);
+        const std::size_t pos = state.cursor.load(std::memory_order_relaxed);
+        state.cached_limit = limit_of(state);
+        const std::size_t available = state.cached_limit - pos;
+        const std::size_t count = n < available ? n : available;
+        const std::size_t start = pos & mask;
+        const std::size_t first_run = count < capacity - start ? count : capacity - start;
+        return ring_span_pair<const T>(ring_span<const T>(arr + start, first_run),
+                                       ring_span<const T>(arr, count - first_run));
+    }
+
+    /**
+     * @brief Moves a consumer's cursor past k elements after they were read in place.
+     *
+     * @param consumer The reading consumer.
+     * @param k The number of elements to release.
+     * @throws std::out_of_range if consumer is not less than Consumers.
+     * @throws std::invalid_argument if k exceeds the number of elements available to this consumer.
+     */
+    void read_release(std::size_t consumer, std::size_t k) {
+        consumer_state &state = state_of(consumer);
+        const std::size_t pos = state.cursor.load(std::memory_order_relaxed);
+        if (k > state.cached_limit - pos) {
+            state.cached_limit = limit_of(state);
+            if (k > state.cached_limit - pos) {
+                CQUEUE_THROW(std::invalid_argument("Cannot release more elements than are available"));
+            }
+        }
+        state.cursor.store(pos + k, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns the number of elements available to a consumer.
+     *
+     * @param consumer The consumer to check.
+     * @return The current number of elements the consumer can read, as a snapshot.
+     * @throws std::out_of_range if consumer is not less than Consumers.
+     */
+    std::size_t get_size(std::size_t consumer) const {
+        const consumer_state &state = state_of(consumer);
+        return limit_of(state) - state.cursor.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns the number of slots held by elements the slowest consumer has not released.
+     *
+     * @return The current occupancy of the ring, as a snapshot.
+     */
+    std::size_t get_size() const {
+        const std::size_t slowest = slowest_cursor();
+        return published.load(std::memory_order_acquire) - slowest;
+    }
+
+    /**
+     * @brief Checks if the slowest consumer has read every element.
+     *
+     * @return True if the producer has nothing outstanding, false otherwise.
+     */
+    bool is_empty() const {
+        return get_size() == 0;
+    }
+
+    /**
+     * @brief Checks if the producer is a full lap ahead of the slowest consumer.
+     *
+     * @return True if the next enqueue would fail, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == capacity;
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the ring.
+     *
+     * @return The capacity of the ring (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Returns the number of consumers.
+     *
+     * @return Consumers.
+     */
+    static constexpr std::size_t get_consumer_count() {
+        return Consumers;
+    }
+
+private:
+
+    consumer_state &state_of(std::size_t consumer) {
+        if (consumer >= Consumers) {
+            CQUEUE_THROW(std::out_of_range("Consumer out of range"));
+        }
+        return consumers[consumer];
+    }
+
+    const consumer_state &state_of(std::size_t consumer) const {
+        if (consumer >= Consumers) {
+            CQUEUE_THROW(std::out_of_range("Consumer out of range"));
+        }
+        return consumers[consumer];
+    }
+
+    /**
+     * @brief Returns the lowest cursor among the consumers nothing depends on.
+     */
+    std::size_t slowest_cursor() const {
+        std::size_t slowest = published.load(std::memory_order_relaxed);
+        for (std::uint64_t bits = gating; bits != 0; bits &= bits - 1) {
+            const std::size_t cursor =
+                consumers[cqueue_detail::count_trailing_zeros(bits)].cursor.load(std::memory_order_acquire);
+            if (cursor < slowest) {
+                slowest = cursor;
+            }
+        }
+        return slowest;
+    }
+
+    /**
+     * @brief Returns the end of the range a consumer may read: what is published and released by its upstream.
+     */
+    std::size_t limit_of(const consumer_state &state) const {
+        std::size_t limit = published.load(std::memory_order_acquire);
+        for (std::uint64_t bits = state.upstream; bits != 0; bits &= bits - 1) {
+            const std::size_t cursor =
+                consumers[cqueue_detail::count_trailing_zeros(bits)].cursor.load(std::memory_order_acquire);
+            if (cursor < limit) {
+                limit = cursor;
+            }
+        }
+        return limit;
+    }
+
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+/**
+ * @brief A lock-free single-producer/single-consumer ring of variable-length byte records.
+ *
+ * Records are stored inline: each is an 8-byte header holding its length,
+ * followed by the payload, padded to a multiple of 8 bytes so every payload
+ * starts 8-byte aligned. A record never wraps around the end of the storage.
+ * When the room left before the end is too small, the producer writes a skip
+ * marker there and places the record at the start, and the consumer jumps
+ * over the marker. A message therefore needs no allocation of its own, and
+ * reader and writer both work on one contiguous run of bytes.
+ *
+ * write_reserve hands the producer a pointer into the ring, and write_commit
+ * publishes the record; read_peek hands the consumer the next record in place,
+ * and read_release frees it. As in spsc_circular_queue, the producer and the
+ * consumer each own one index on its own cache line and keep a private copy of
+ * the other side's index, and a full ring rejects new records.
+ *
+ * Because the skipped room at the end counts against the free space, a record
+ * of up to half the capacity always fits once the ring has drained; larger
+ * records are refused outright.
+ */
+class byte_ring {
+
+    static constexpr std::size_t header_size = 8;                       ///< Bytes before each payload; also the record alignment
+    static constexpr std::uint32_t skip_marker = 0xFFFFFFFFu;           ///< Header length of the padding before a wrap
+
+    // Read-only after construction; shared by both sides without invalidations
+    alignas(cqueue_detail::cache_line_size) std::unique_ptr<std::uint64_t[]> storage;  ///< 8-byte aligned record storage
+    unsigned char *bytes{};                                             ///< storage as bytes
+    std::size_t capacity{}, mask{};                                     ///< Number of bytes and index mask
+
+    // Producer line
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> tail{0};  ///< End of the published records
+    std::size_t cached_head{0};                                         ///< Producer's last observed value of head
+    std::size_t reserved_at{0};                                         ///< Position of the reserved record's header
+    std::size_t reserved_length{0};                                     ///< Payload bytes reserved
+    bool reserved{false};                                               ///< Whether a reservation is pending
+
+    // Consumer line
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> head{0};  ///< Start of the oldest record, published to the producer
+    std::size_t cached_tail{0};                                         ///< Consumer's last observed value of tail
+    std::size_t peeked_end{0};                                          ///< End of the record handed out by read_peek
+
+public:
+
+    /**
+     * @brief Constructor that creates an empty ring.
+     *
+     * @param n The minimum number of bytes the ring must hold, headers and padding included; rounded up to a power of two of at least 16.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit byte_ring(std::size_t n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        capacity = cqueue_detail::next_power_of_two(n < 2 * header_size ? 2 * header_size : n);
+        mask = capacity - 1;
+        storage.reset(new std::uint64_t[capacity / sizeof(std::uint64_t)]);
+        bytes = reinterpret_cast<unsigned char *>(storage.get());
+    }
+
+    byte_ring(const byte_ring &) = delete;
+    byte_ring &operator=(const byte_ring &) = delete;
+
+    /**
+     * @brief Reserves room for a record and returns where to write its payload. Producer only.
+     *
+     * The record becomes visible to the consumer on write_commit. A second
+     * reservation before that replaces the first.
+     *
+     * @param length The number of payload bytes to reserve.
+     * @return A pointer to length writable bytes, 8-byte aligned, or nullptr if the ring has no room for them now.
+     * @throws std::length_error if length exceeds get_max_record_size().
+     */
+    unsigned char *write_reserve(std::size_t length) {
+        if (length > get_max_record_size()) {
+            CQUEUE_THROW(std::length_error("Record is larger than the ring can hold"));
+        }
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        const std::size_t needed = padded(length);
+        const std::size_t to_end = capacity - (t & mask);
+        // A record that does not fit before the end also uses up the room there
+        const std::size_t required = needed <= to_end ? needed : to_end + needed;
+        if (capacity - (t - cached_head) < required) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (capacity - (t - cached_head) < required) {
+                return nullptr;
+            }
+        }
+
+        std::size_t at = t;
+        if (needed > to_end) {
+            write_header(t, skip_marker);
+            at = t + to_end;
+        }
+        reserved_at = at;
+        reserved_length = length;
+        reserved = true;
+        return bytes + (at & mask) + header_size;
+    }
+
+    /**
+     * @brief Publishes the reserved record with its full reserved length. Producer only.
+     *
+     * @throws std::logic_error if there is no pending reservation.
+     */
+    void write_commit() {
+        write_commit(reserved_length);
+    }
+
+    /**
+     * @brief Publishes the reserved record, shortened to length bytes. Producer only.
+     *
+     * @param length The number of payload bytes actually written.
+     * @throws std::logic_error if there is no pending reservation.
+     * @throws std::invalid_argument if length exceeds the reserved length.
+     */
+    void write_commit(std::size_t length) {
+        if (!reserved) {
+            CQUEUE_THROW(std::logic_error("No reservation to commit"));
+        }
+        if (length > reserved_length) {
+            CQUEUE_THROW(std::invalid_argument("Cannot commit more bytes than were reserved"));
+        }
+        write_header(reserved_at, static_cast<std::uint32_t>(length));
+        reserved = false;
+        tail.store(reserved_at + padded(length), std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies a record into the ring. Producer only.
+     *
+     * @param data Pointer to the payload.
+     * @param length The number of payload bytes.
+     * @return True if the record was added, false if the ring has no room for it now.
+     * @throws std::length_error if length exceeds get_max_record_size().
+     */
+    bool try_enqueue(const void *data, std::size_t length) {
+        unsigned char *payload = write_reserve(length);
+        if (payload == nullptr) {
+            return false;
+        }
+        if (length != 0) {
+            std::memcpy(payload, data, length);
+        }
+        write_commit(length);
+        return true;
+    }
+
+    /**
+     * @brief Exposes the oldest record for reading in place. Consumer only.
+     *
+     * The record stays valid and in the ring until read_release; calling
+     * read_peek again before that returns the same record.
+     *
+     * @param record Receives the payload of the record, 8-byte aligned.
+     * @return True if a record is available, false if the ring is empty.
+     */
+    bool read_peek(ring_span<const unsigned char> &record) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        std::uint32_t length = read_header(h);
+        if (length == skip_marker) {
+            // The marker is published together with the record after it, so that record is there
+            h += capacity - (h & mask);
+            head.store(h, std::memory_order_release);
+            length = read_header(h);
+        }
+        record = ring_span<const unsigned char>(bytes + (h & mask) + header_size, length);
+        peeked_end = h + padded(length);
+        return true;
+    }
+
+    /**
+     * @brief Frees the record returned by the last read_peek. Consumer only.
+     *
+     * @throws std::logic_error if no record has been peeked since the last release.
+     */
+    void read_release() {
+        if (peeked_end == head.load(std::memory_order_relaxed)) {
+            CQUEUE_THROW(std::logic_error("No record to release"));
+        }
+        head.store(peeked_end, std::memory_order_release);
+    }
+
+    /**
+     * @brief Checks if the ring holds no records.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the ring is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return get_used_bytes() == 0;
+    }
+
+    /**
+     * @brief Returns the number of bytes taken by published records, headers and padding included.
+     *
+     * @return The current usage of the ring, as a snapshot.
+     */
+    std::size_t get_used_bytes() const {
+        const std::size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    /**
+     * @brief Returns the size of the ring in bytes.
+     *
+     * @return The capacity of the ring (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Returns the largest payload write_reserve accepts.
+     *
+     * @return Half the capacity minus the record header.
+     */
+    std::size_t get_max_record_size() const {
+        const std::size_t limit = capacity / 2 - header_size;
+        return limit < skip_marker ? limit : skip_marker - 1;
+    }
+
+private:
+
+    /**
+     * @brief Returns the room a record of the given payload length takes, header and padding included.
+     */
+    static std::size_t padded(std::size_t length) {
+        return (header_size + length + header_size - 1) & ~(header_size - 1);
+    }
+
+    void write_header(std::size_t pos, std::uint32_t length) {
+        std::memcpy(bytes + (pos & mask), &length, sizeof(length));
+    }
+
+    std::uint32_t read_header(std::size_t pos) const {
+        std::uint32_t length;
+        std::memcpy(&length, bytes + (pos & mask), sizeof(length));
+        return length;
+    }
+
+};
@@ -1,48 +1,156 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <functional>
 #include <vector>
 #include <stdexcept>
 #include <memory>
-#include <string>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "queue_detail.hpp"
+#include "queue_logger.hpp"
+#include "queue_overflow.hpp"
+#include "ring_iterator.hpp"
+#include "ring_span.hpp"
 
 /**
- * @brief A template-based circular queue implementation with a fixed size and callback support.
+ * @brief A template-based circular queue implementation with a fixed size and logging support.
  *
  * This class implements a circular queue with the capability of storing elements
  * of any type. It efficiently manages the data by reusing space when the queue
  * wraps around. The queue is fixed-size, and its size is defined at the time of
- * construction. Optionally, a callback function can be registered to log events
- * such as enqueue, dequeue, and state changes.
+ * construction. Events such as enqueue, dequeue, and state changes are reported
+ * to a logger policy chosen at compile time: the default no_log policy compiles
+ * away completely, event_log forwards structured event codes and values to a
+ * callback, and string_log formats human-readable messages.
+ *
+ * The positions of the front and rear are free-running 64-bit counters: the
+ * size is tail - head and a slot is counter & mask, so no operation needs a
+ * separate size field or an empty-queue sentinel. The backing storage is
+ * rounded up to a power of two for that mask; the logical capacity is still
+ * exactly the size requested. Choosing a power-of-two capacity avoids the extra
+ * slots entirely.
+ *
+ * Slots are left uninitialized until an element is constructed in them, so T
+ * does not need to be default constructible, and each element is destroyed as
+ * soon as it is dequeued, overwritten or cleared. Elements can be moved in,
+ * constructed in place with emplace, and are moved out by dequeue. begin() and
+ * end() expose the live elements, front first, as a random-access range for
+ * standard algorithms without copying them.
+ *
+ * What happens when an element is added to a full queue is decided by the
+ * Overflow policy (see queue_overflow.hpp): by default the oldest element is
+ * overwritten, but the new element can also be rejected, dropped and counted,
+ * or reported with an exception. get_dropped_count tells how many elements
+ * were lost to overflow.
+ *
+ * Storage comes from the Allocator parameter. Besides std::allocator,
+ * queue_allocator.hpp provides allocators for huge pages, NUMA-local memory
+ * and caller-provided arenas. Stateless allocators, like stateless loggers,
+ * take up no space in the queue.
  *
  * @tparam T The type of elements in the queue (e.g., int, std::string).
+ * @tparam Logger The logger policy invoked for queue events (see queue_logger.hpp).
+ * @tparam Overflow The policy applied when the queue is full (see queue_overflow.hpp).
+ * @tparam Allocator The allocator that provides the element storage.
  */
-template<typename T>
-class circular_queue {
+template<typename T, typename Logger = no_log, typename Overflow = overwrite_oldest,
+    typename Allocator = std::allocator<T>>
+class circular_queue : private Logger, private Allocator {
+
+    static_assert(std::is_same<typename Allocator::value_type, T>::value, "Allocator::value_type must be T");
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same<typename allocator_traits::pointer, T *>::value, "Allocator must use raw pointers");
+
+    /// Whether try_dequeue(T&) can neither throw from moving the element nor from logging it
+    static constexpr bool nothrow_dequeue = std::is_nothrow_move_assignable<T>::value &&
+        noexcept(std::declval<Logger &>()(queue_event::dequeued, static_cast<const T *>(nullptr), std::size_t()));
 
-    std::unique_ptr<T[]> arr;                           ///< Array that holds the queue elements
-    int front{}, rear{}, size{}, capacity{};            ///< Indices for the front, rear, size, and capacity of the queue
-    std::function<void(const std::string &)> logger;    ///< Optional callback for logging events
+    T *arr{};                                           ///< Uninitialized storage that holds the queue elements
+    std::uint64_t head{}, tail{};                       ///< Free-running counters of removed and added elements
+    std::size_t capacity{};                             ///< Maximum number of elements in the queue
+    std::size_t mask{};                                 ///< Index mask for the power-of-two sized storage
+    std::size_t dropped{};                              ///< Elements overwritten or dropped because the queue was full
 
 public:
 
+    using value_type = T;
+    using iterator = ring_iterator<T>;
+    using const_iterator = ring_iterator<const T>;
+
     /**
      * @brief Constructor that initializes the circular queue with a fixed size.
      *
-     * Initializes the queue with the given capacity. Optionally, a callback
-     * function can be passed to log various events (enqueue, dequeue, etc.).
+     * Initializes the queue with the given capacity. Optionally, a configured
+     * logger policy can be passed to log various events (enqueue, dequeue, etc.),
+     * and a configured allocator to supply the storage.
      *
      * @param n The maximum size of the queue.
-     * @param callback An optional callback function to log events.
-     * @throws std::invalid_argument if the given size is less than or equal to 0.
+     * @param logger The logger policy instance that receives queue events.
+     * @param allocator The allocator instance that provides the storage.
+     * @throws std::invalid_argument if the given size is 0.
+     * @throws std::length_error if the storage for the given size cannot be addressed.
+     */
+    explicit circular_queue(std::size_t n, const Logger &logger = Logger(), const Allocator &allocator = Allocator())
+        : Logger(logger), Allocator(allocator), capacity(n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        const std::size_t slots = cqueue_detail::next_power_of_two(n);
+        arr = allocator_traits::allocate(get_allocator(), slots);
+        mask = slots - 1;
+    }
+
+    circular_queue(const circular_queue &) = delete;
+    circular_queue &operator=(const circular_queue &) = delete;
+
+    /**
+     * @brief Move constructor that takes over the storage of another queue.
+     *
+     * The allocator is moved along with the storage. The moved-from queue is
+     * left without storage and may only be destroyed or assigned to.
+     *
+     * @param other The queue to move from.
      */
-    explicit circular_queue(int n, const std::function<void(const std::string &)> &callback = nullptr)
-        : front(-1), rear(-1), capacity(n), logger(callback) {
-        if (n <= 0) {
-            throw std::invalid_argument("Queue capacity must be greater than 0.");
+    circular_queue(circular_queue &&other) noexcept
+        : Logger(std::move(static_cast<Logger &>(other))), Allocator(std::move(other.get_allocator())), arr(other.arr),
+          head(other.head), tail(other.tail), capacity(other.capacity), mask(other.mask), dropped(other.dropped) {
+        other.release_storage();
+    }
+
+    /**
+     * @brief Move assignment that destroys the current elements and takes over the storage of another queue.
+     *
+     * @param other The queue to move from.
+     * @return A reference to this queue.
+     */
+    circular_queue &operator=(circular_queue &&other) noexcept {
+        if (this != &other) {
+            destroy_storage();
+            static_cast<Logger &>(*this) = std::move(static_cast<Logger &>(other));
+            get_allocator() = std::move(other.get_allocator());
+            arr = other.arr;
+            head = other.head;
+            tail = other.tail;
+            capacity = other.capacity;
+            mask = other.mask;
+            dropped = other.dropped;
+            other.release_storage();
         }
-        arr = std::make_unique<T[]>(n);
+        return *this;
+    }
+
+    /**
+     * @brief Destructor that destroys the remaining elements and frees the storage.
+     */
+    ~circular_queue() {
+        destroy_storage();
     }
 
     /**
@@ -51,7 +159,7 @@ public:
      * @return True if the queue is full, false otherwise.
      */
     bool is_full() const {
-        return size == capacity;
+        return tail - head == capacity;
     }
 
     /**
@@ -60,66 +168,291 @@ public:
      * @return True if the queue is empty, false otherwise.
      */
     bool is_empty() const {
-        return size == 0;
+        return head == tail;
     }
 
     /**
-     * @brief Adds an element to the rear of the queue.
+     * @brief Copies an element to the rear of the queue.
      *
-     * If the queue is full, the oldest element (front) will be overwritten.
-     * This ensures that the queue never grows beyond its fixed capacity.
+     * If the queue is full, the Overflow policy decides what happens: by
+     * default the oldest element (front) is overwritten, so the queue never
+     * grows beyond its fixed capacity.
      *
      * @param value The element to be added to the queue.
-     * @throws std::overflow_error if the queue is full and cannot add the new element.
+     * @return True if the element was stored, false if the policy refused it.
+     * @throws std::overflow_error if the queue is full and the policy is throw_on_overflow.
      */
-    void enqueue(T value) {
-        if (is_full()) {
-            // If the queue is full, overwrite the oldest element (front)
-            front = (front + 1) % capacity;
-            size--; // Decrease size temporarily to allow inserting at the rear
-        }
-
-        if (is_empty()) {
-            front = rear = 0;
-        } else {
-            rear = (rear + 1) % capacity;
-        }
+    bool enqueue(const T &value) {
+        return emplace(value) != nullptr;
+    }
 
-        arr[rear] = value;
-        size++;
+    /**
+     * @brief Moves an element to the rear of the queue.
+     *
+     * If the queue is full, the Overflow policy decides what happens. When the
+     * element is refused, it is not moved from.
+     *
+     * @param value The element to be moved into the queue.
+     * @return True if the element was stored, false if the policy refused it.
+     * @throws std::overflow_error if the queue is full and the policy is throw_on_overflow.
+     */
+    bool enqueue(T &&value) {
+        return emplace(std::move(value)) != nullptr;
+    }
 
-        if (logger) {
-            logger("Enqueued: " + std::to_string(value));
+    /**
+     * @brief Constructs an element in place at the rear of the queue.
+     *
+     * If the queue is full, the Overflow policy decides what happens. With
+     * overwrite_oldest, the oldest element (front) is destroyed and
+     * overwritten; the new element is built before the oldest one is
+     * destroyed, so the arguments may safely refer to it. If the constructor
+     * of T throws, no element is added.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return A pointer to the newly added element, or nullptr if the policy refused it.
+     * @throws std::overflow_error if the queue is full and the policy is throw_on_overflow.
+     */
+    template<typename... Args>
+    T *emplace(Args &&... args) {
+        if (is_full()) {
+            log(queue_event::full, nullptr, 0);
+            return emplace_when_full(Overflow(), std::forward<Args>(args)...);
         }
+        return &construct_at_rear(std::forward<Args>(args)...);
     }
 
     /**
      * @brief Removes and returns the front element of the queue.
      *
-     * If the queue is empty, an underflow error will be thrown.
+     * The element is moved out of its slot, which is destroyed immediately. If
+     * the queue is empty, an underflow error will be thrown.
      *
      * @return The element removed from the front of the queue.
      * @throws std::underflow_error if the queue is empty.
      */
     T dequeue() {
         if (is_empty()) {
-            throw std::underflow_error("Queue is empty");
+            log(queue_event::empty, nullptr, 0);
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
         }
 
-        T value = arr[front];
-        if (front == rear) {
-            front = rear = -1; // Queue becomes empty after dequeue
-        } else {
-            front = (front + 1) % capacity;
+        T value = std::move(arr[slot_of(head)]);
+        pop_front();
+
+        log(queue_event::dequeued, &value, 1);
+
+        return value;
+    }
+
+    /**
+     * @brief Removes the front element of the queue into out, if there is one.
+     *
+     * The non-throwing counterpart of dequeue for polling: an empty queue is
+     * reported through the return value and out is left untouched. It does not
+     * throw as long as the move assignment of T and the logger policy do not.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue was empty.
+     */
+    bool try_dequeue(T &out) noexcept(nothrow_dequeue) {
+        if (is_empty()) {
+            log(queue_event::empty, nullptr, 0);
+            return false;
         }
-        size--;
 
-        if (logger) {
-            logger("Dequeued: " + std::to_string(value));
+        out = std::move(arr[slot_of(head)]);
+        pop_front();
+
+        log(queue_event::dequeued, &out, 1);
+        return true;
+    }
+
+#if CQUEUE_HAS_OPTIONAL
+    /**
+     * @brief Removes and returns the front element of the queue, if there is one.
+     *
+     * @return The removed element, or an empty optional if the queue was empty.
+     */
+    std::optional<T> try_dequeue() {
+        if (is_empty()) {
+            log(queue_event::empty, nullptr, 0);
+            return std::nullopt;
         }
 
+        std::optional<T> value(std::move(arr[slot_of(head)]));
+        pop_front();
+
+        log(queue_event::dequeued, &*value, 1);
         return value;
     }
+#endif
+
+    /**
+     * @brief Copies a contiguous range of elements to the rear of the queue.
+     *
+     * Behaves like calling enqueue for every element in order, but the copy is
+     * done in at most two runs (one on each side of the wrap point), so
+     * trivially copyable types are copied with memmove-like bandwidth. When the
+     * range does not fit, the Overflow policy applies: overwrite_oldest makes
+     * room by overwriting the oldest elements (if the range is longer than the
+     * capacity, only its last capacity elements remain), reject_newest and
+     * drop_newest store the leading elements that fit, and throw_on_overflow
+     * stores nothing.
+     *
+     * @param first Pointer to the first element to add.
+     * @param n The number of elements to add.
+     * @return The number of elements taken from the range: n with overwrite_oldest, otherwise the number that fit.
+     * @throws std::overflow_error if the range does not fit and the policy is throw_on_overflow.
+     */
+    std::size_t enqueue_bulk(const T *first, std::size_t n) {
+        const std::size_t accepted = n;
+        const std::size_t room = capacity - get_size();
+        if (n > room) {
+            log(queue_event::full, nullptr, 0);
+            n = fit_bulk(Overflow(), first, n, room);
+        }
+        if (n == 0) {
+            return 0;
+        }
+
+        const std::size_t slots = mask + 1;
+        const std::size_t start = slot_of(tail);
+        const std::size_t first_run = n < slots - start ? n : slots - start;
+        std::uninitialized_copy(first, first + first_run, arr + start);
+        CQUEUE_TRY {
+            std::uninitialized_copy(first + first_run, first + n, arr);
+        } CQUEUE_CATCH_ALL {
+            for (std::size_t i = 0; i < first_run; ++i) {
+                arr[start + i].~T();
+            }
+            CQUEUE_RETHROW;
+        }
+
+        tail += n;
+
+        log(queue_event::enqueued, first, n);
+        return std::is_same<Overflow, overwrite_oldest>::value ? accepted : n;
+    }
+
+    /**
+     * @brief Removes up to max elements from the front of the queue.
+     *
+     * The elements are moved into the output range in at most two runs and
+     * their slots are destroyed. Unlike dequeue, an empty queue is not an error.
+     *
+     * @param out Pointer to the first of at least max elements that receive the removed values.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t dequeue_bulk(T *out, std::size_t max) {
+        const std::size_t size = get_size();
+        const std::size_t count = max < size ? max : size;
+        if (count == 0) {
+            if (max != 0) {
+                log(queue_event::empty, nullptr, 0);
+            }
+            return 0;
+        }
+
+        const std::size_t slots = mask + 1;
+        const std::size_t start = slot_of(head);
+        const std::size_t first_run = count < slots - start ? count : slots - start;
+        std::move(arr + start, arr + start + first_run, out);
+        std::move(arr, arr + (count - first_run), out + first_run);
+        destroy_range(start, count);
+        head += count;
+
+        log(queue_event::dequeued, out, count);
+        return count;
+    }
+
+    /**
+     * @brief Reserves free slots at the rear of the queue for direct writing.
+     *
+     * Returns up to n free slots as at most two contiguous spans, split at the
+     * wrap point, so the caller can fill them in place (for example straight
+     * from recv()). Nothing is added to the queue until write_commit is called,
+     * and a reservation never overwrites existing elements. The queue must not
+     * be modified between the reservation and its commit.
+     *
+     * Only available for trivially copyable types, since the reserved slots are
+     * raw storage that the caller writes to.
+     *
+     * @param n The maximum number of slots to reserve.
+     * @return The reserved slots, in order; their total size may be less than n.
+     */
+    ring_span_pair<T> write_reserve(std::size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "write_reserve requires a trivially copyable type");
+        const std::size_t room = capacity - get_size();
+        return spans_from(slot_of(tail), n < room ? n : room);
+    }
+
+    /**
+     * @brief Adds the first k slots of the preceding write_reserve to the queue.
+     *
+     * @param k The number of slots that were written.
+     * @throws std::invalid_argument if k exceeds the free space of the queue.
+     */
+    void write_commit(std::size_t k) {
+        static_assert(std::is_trivially_copyable<T>::value, "write_commit requires a trivially copyable type");
+        if (k > capacity - get_size()) {
+            CQUEUE_THROW(std::invalid_argument("Cannot commit more elements than were reserved"));
+        }
+        if (k == 0) {
+            return;
+        }
+
+        const std::size_t start = slot_of(tail);
+        tail += k;
+
+        const ring_span_pair<T> added = spans_from(start, k);
+        log(queue_event::enqueued, added.first.data(), added.first.size());
+        if (!added.second.empty()) {
+            log(queue_event::enqueued, added.second.data(), added.second.size());
+        }
+    }
+
+    /**
+     * @brief Exposes up to n elements at the front of the queue for reading in place.
+     *
+     * The elements are returned as at most two contiguous spans, split at the
+     * wrap point, and stay in the queue until read_release is called.
+     *
+     * @param n The maximum number of elements to expose.
+     * @return The front elements, in order; their total size may be less than n.
+     */
+    ring_span_pair<T> read_peek(std::size_t n) {
+        const std::size_t available = get_size();
+        return spans_from(slot_of(head), n < available ? n : available);
+    }
+
+    /**
+     * @brief Exposes up to n elements at the front of the queue for reading in place.
+     *
+     * @param n The maximum number of elements to expose.
+     * @return The front elements, in order; their total size may be less than n.
+     */
+    ring_span_pair<const T> read_peek(std::size_t n) const {
+        const std::size_t available = get_size();
+        const ring_span_pair<T> spans = spans_from(slot_of(head), n < available ? n : available);
+        return ring_span_pair<const T>(spans.first, spans.second);
+    }
+
+    /**
+     * @brief Removes the first k elements of the queue after they were read in place.
+     *
+     * @param k The number of elements to remove.
+     * @throws std::invalid_argument if k exceeds the current size.
+     */
+    void read_release(std::size_t k) {
+        if (k > get_size()) {
+            CQUEUE_THROW(std::invalid_argument("Cannot release more elements than the queue holds"));
+        }
+        if (k != 0) {
+            discard_front(k, queue_event::dequeued);
+        }
+    }
 
     /**
      * @brief Retrieves the front element without removing it.
@@ -132,9 +465,27 @@ public:
      */
     T peek() const {
         if (is_empty()) {
-            throw std::underflow_error("Queue is empty");
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
         }
-        return arr[front];
+        return arr[slot_of(head)];
+    }
+
+    /**
+     * @brief Returns the front element without removing it, if there is one.
+     *
+     * @return A pointer to the front element, or nullptr if the queue is empty.
+     */
+    T *try_peek() noexcept {
+        return is_empty() ? nullptr : arr + slot_of(head);
+    }
+
+    /**
+     * @brief Returns the front element without removing it, if there is one.
+     *
+     * @return A pointer to the front element, or nullptr if the queue is empty.
+     */
+    const T *try_peek() const noexcept {
+        return is_empty() ? nullptr : arr + slot_of(head);
     }
 
     /**
@@ -150,24 +501,23 @@ public:
         }
 
         std::cout << "Queue elements: ";
-        for (int i = 0; i < size; ++i) {
-            std::cout << arr[(front + i) % capacity] << " ";
+        for (std::uint64_t i = head; i != tail; ++i) {
+            std::cout << arr[slot_of(i)] << " ";
         }
         std::cout << std::endl;
     }
 
     /**
-     * @brief Clears the queue by resetting its front and rear pointers.
+     * @brief Clears the queue by destroying every element.
      *
-     * This function empties the queue and logs the clearing event if a logger
-     * callback is provided.
+     * This function empties the queue and reports the clearing event, with the
+     * number of discarded elements, to the logger policy.
      */
     void clear() {
-        front = rear = -1;
-        size = 0;
-        if (logger) {
-            logger("Queue cleared");
-        }
+        const std::size_t discarded = get_size();
+        destroy_elements();
+        head = tail;
+        log(queue_event::cleared, nullptr, discarded);
     }
 
     /**
@@ -179,29 +529,153 @@ public:
      * @return A vector containing all elements in the queue.
      */
     std::vector<T> get_all_elements() const {
-        std::vector<T> elements;
-        for (int i = 0; i < size; ++i) {
-            elements.push_back(arr[(front + i) % capacity]);
+        return std::vector<T>(begin(), end());
+    }
+
+    /**
+     * @brief Writes the elements, front first, as one binary snapshot.
+     *
+     * The writer is called once, with the snapshot header followed by the
+     * elements as raw bytes in at most two runs that point straight into the
+     * queue. A writer that hands all chunks to one writev (see fd_writer in
+     * queue_snapshot.hpp) therefore copies nothing in user space, and restore
+     * reads the snapshot back. The queue is not modified.
+     *
+     * Only available for trivially copyable types.
+     *
+     * @param writer Called as writer(const ring_span<const unsigned char> *chunks, std::size_t count); must write every chunk, in order, or throw.
+     */
+    template<typename Writer>
+    void snapshot(Writer &&writer) const {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot requires a trivially copyable type");
+        const cqueue_detail::snapshot_header header{cqueue_detail::snapshot_magic, cqueue_detail::snapshot_version,
+                                                    static_cast<std::uint32_t>(sizeof(T)), get_size()};
+        const ring_span_pair<const T> elements = read_peek(get_size());
+
+        ring_span<const unsigned char> chunks[3];
+        std::size_t count = 0;
+        chunks[count++] = ring_span<const unsigned char>(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+        if (!elements.first.empty()) {
+            chunks[count++] = ring_span<const unsigned char>(reinterpret_cast<const unsigned char *>(elements.first.data()),
+                                                             elements.first.size() * sizeof(T));
+        }
+        if (!elements.second.empty()) {
+            chunks[count++] = ring_span<const unsigned char>(reinterpret_cast<const unsigned char *>(elements.second.data()),
+                                                             elements.second.size() * sizeof(T));
         }
-        return elements;
+        writer(static_cast<const ring_span<const unsigned char> *>(chunks), count);
+    }
+
+    /**
+     * @brief Replaces the contents of the queue with a snapshot written by snapshot.
+     *
+     * The reader is called twice: once for the header, then once with a single
+     * run of free slots that it fills with all of the elements, so no element
+     * is enqueued one at a time and no intermediate buffer is needed. If the
+     * second call throws, the queue is left empty.
+     *
+     * Only available for trivially copyable types.
+     *
+     * @param reader Called as reader(const ring_span<unsigned char> *chunks, std::size_t count); must fill every chunk, in order, or throw.
+     * @throws std::invalid_argument if the data is not a snapshot of elements of this size.
+     * @throws std::length_error if the snapshot holds more elements than the capacity of the queue.
+     */
+    template<typename Reader>
+    void restore(Reader &&reader) {
+        static_assert(std::is_trivially_copyable<T>::value, "restore requires a trivially copyable type");
+        cqueue_detail::snapshot_header header{};
+        const ring_span<unsigned char> header_chunk(reinterpret_cast<unsigned char *>(&header), sizeof(header));
+        reader(&header_chunk, std::size_t(1));
+        if (header.magic != cqueue_detail::snapshot_magic || header.version != cqueue_detail::snapshot_version ||
+            header.element_size != sizeof(T)) {
+            CQUEUE_THROW(std::invalid_argument("Data is not a snapshot of this queue type"));
+        }
+        if (header.count > capacity) {
+            CQUEUE_THROW(std::length_error("Snapshot holds more elements than the queue can"));
+        }
+
+        clear();
+        head = tail = 0;            // Start at slot 0 so the elements land in one run
+        const std::size_t count = static_cast<std::size_t>(header.count);
+        if (count == 0) {
+            return;
+        }
+        const ring_span<unsigned char> slots(reinterpret_cast<unsigned char *>(write_reserve(count).first.data()),
+                                             count * sizeof(T));
+        reader(&slots, std::size_t(1));
+        write_commit(count);
     }
 
     /**
      * @brief Retrieves the element at a specific index in the queue.
      *
      * The index is relative to the front of the queue. If the index is out of
-     * range (i.e., less than 0 or greater than or equal to the size), an exception
-     * will be thrown.
+     * range (i.e., greater than or equal to the size), an exception will be
+     * thrown.
      *
      * @param index The index of the element to retrieve (0-based, relative to the front).
      * @return The element at the specified index.
      * @throws std::out_of_range if the index is invalid.
      */
-    T get_element_at(int index) const {
-        if (index < 0 || index >= size) {
-            throw std::out_of_range("Index out of range");
+    T get_element_at(std::size_t index) const {
+        if (index >= get_size()) {
+            CQUEUE_THROW(std::out_of_range("Index out of range"));
         }
-        return arr[(front + index) % capacity];
+        return arr[slot_of(head + index)];
+    }
+
+    /**
+     * @brief Accesses the element at a position relative to the front, without a range check.
+     *
+     * @param index The position of the element; must be less than get_size().
+     * @return A reference to the element.
+     */
+    T &operator[](std::size_t index) noexcept {
+        return arr[slot_of(head + index)];
+    }
+
+    /**
+     * @brief Accesses the element at a position relative to the front, without a range check.
+     *
+     * @param index The position of the element; must be less than get_size().
+     * @return A const reference to the element.
+     */
+    const T &operator[](std::size_t index) const noexcept {
+        return arr[slot_of(head + index)];
+    }
+
+    /**
+     * @brief Returns an iterator to the front element.
+     *
+     * @return An iterator that walks the elements from the front to the rear.
+     */
+    iterator begin() noexcept {
+        return iterator(arr, mask, static_cast<std::size_t>(head));
+    }
+
+    /**
+     * @brief Returns an iterator past the rear element.
+     *
+     * @return The end iterator.
+     */
+    iterator end() noexcept {
+        return iterator(arr, mask, static_cast<std::size_t>(tail));
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(arr, mask, static_cast<std::size_t>(head));
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(arr, mask, static_cast<std::size_t>(tail));
     }
 
     /**
@@ -209,28 +683,44 @@ public:
      *
      * If the new capacity is less than the current size, an exception is thrown.
      * This ensures that the queue does not lose any elements in the process.
+     * Every element is moved in this call, so it takes O(size) time; use
+     * growable_circular_queue when a queue has to grow under load.
      *
      * @param new_capacity The new capacity of the queue.
-     * @throws std::invalid_argument if new_capacity is less than the current size.
+     * @throws std::invalid_argument if new_capacity is 0 or less than the current size.
      */
-    void resize(int new_capacity) {
+    void resize(std::size_t new_capacity) {
+        const std::size_t size = get_size();
+        if (new_capacity == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
         if (new_capacity < size) {
-            throw std::invalid_argument("New capacity cannot be less than the current size");
+            CQUEUE_THROW(std::invalid_argument("New capacity cannot be less than the current size"));
         }
 
-        auto new_arr = std::make_unique<T[]>(new_capacity);
-        for (int i = 0; i < size; ++i) {
-            new_arr[i] = arr[(front + i) % capacity];
+        const std::size_t slots = cqueue_detail::next_power_of_two(new_capacity);
+        T *new_arr = allocator_traits::allocate(get_allocator(), slots);
+        std::size_t moved = 0;
+        CQUEUE_TRY {
+            for (; moved < size; ++moved) {
+                ::new(static_cast<void *>(new_arr + moved)) T(std::move_if_noexcept(arr[slot_of(head + moved)]));
+            }
+        } CQUEUE_CATCH_ALL {
+            for (std::size_t i = 0; i < moved; ++i) {
+                new_arr[i].~T();
+            }
+            allocator_traits::deallocate(get_allocator(), new_arr, slots);
+            CQUEUE_RETHROW;
         }
 
-        arr = std::move(new_arr);
+        destroy_storage();
+        arr = new_arr;
         capacity = new_capacity;
-        front = 0;
-        rear = size - 1;
+        mask = slots - 1;
+        head = 0;
+        tail = size;
 
-        if (logger) {
-            logger("Queue resized to capacity: " + std::to_string(new_capacity));
-        }
+        log(queue_event::resized, nullptr, new_capacity);
     }
 
     /**
@@ -240,8 +730,8 @@ public:
      *
      * @return The current size of the queue.
      */
-    int get_size() const {
-        return size;
+    std::size_t get_size() const {
+        return static_cast<std::size_t>(tail - head);
     }
 
     /**
@@ -251,8 +741,259 @@ public:
      *
      * @return The capacity of the queue.
      */
-    int get_capacity() const {
+    std::size_t get_capacity() const {
         return capacity;
     }
 
+    /**
+     * @brief Returns the number of elements lost because the queue was full.
+     *
+     * Counts the elements overwritten by overwrite_oldest and the elements
+     * discarded by drop_newest since the queue was created. Elements refused
+     * by reject_newest stay with the caller and are not counted.
+     *
+     * @return The number of overwritten or dropped elements.
+     */
+    std::size_t get_dropped_count() const {
+        return dropped;
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters kept by the logger policy.
+     *
+     * Only available when the policy provides stats(), such as stats_log (see
+     * queue_stats.hpp). The snapshot may be taken from any thread.
+     *
+     * @return The counters of the logger policy.
+     */
+    template<typename L = Logger>
+    auto stats() const noexcept -> decltype(std::declval<const L &>().stats()) {
+        return static_cast<const Logger &>(*this).stats();
+    }
+
+private:
+
+    /**
+     * @brief Overwrites the oldest element with a new one.
+     */
+    template<typename... Args>
+    T *emplace_when_full(overwrite_oldest, Args &&... args) {
+        T value(std::forward<Args>(args)...);
+        discard_front(1);
+        return &construct_at_rear(std::move(value));
+    }
+
+    /**
+     * @brief Refuses the new element.
+     */
+    template<typename... Args>
+    T *emplace_when_full(reject_newest, Args &&...) {
+        log(queue_event::rejected, nullptr, 1);
+        return nullptr;
+    }
+
+    /**
+     * @brief Drops the new element without constructing it.
+     */
+    template<typename... Args>
+    T *emplace_when_full(drop_newest, Args &&...) {
+        ++dropped;
+        log(queue_event::dropped, nullptr, 1);
+        return nullptr;
+    }
+
+    /**
+     * @brief Reports the full queue with an exception.
+     */
+    template<typename... Args>
+    T *emplace_when_full(throw_on_overflow, Args &&...) {
+        log(queue_event::rejected, nullptr, 1);
+        CQUEUE_THROW(std::overflow_error("Queue is full"));
+    }
+
+    /**
+     * @brief Makes room for a range by overwriting the oldest elements.
+     *
+     * @param first Pointer to the range; advanced past elements that the range itself would overwrite.
+     * @param n The length of the range.
+     * @param room The number of free slots.
+     * @return The number of elements to store.
+     */
+    std::size_t fit_bulk(overwrite_oldest, const T *&first, std::size_t n, std::size_t room) {
+        const std::size_t cap = capacity;
+        if (n > cap) {
+            // Elements that would be overwritten by the same batch are never stored
+            log(queue_event::dropped, first, n - cap);
+            dropped += n - cap;
+            first += n - cap;
+            n = cap;
+        }
+        if (n > room) {
+            discard_front(n - room);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Keeps the leading elements of a range that fit and refuses the rest.
+     */
+    std::size_t fit_bulk(reject_newest, const T *&first, std::size_t n, std::size_t room) {
+        log(queue_event::rejected, first + room, n - room);
+        return room;
+    }
+
+    /**
+     * @brief Keeps the leading elements of a range that fit and drops the rest.
+     */
+    std::size_t fit_bulk(drop_newest, const T *&first, std::size_t n, std::size_t room) {
+        dropped += n - room;
+        log(queue_event::dropped, first + room, n - room);
+        return room;
+    }
+
+    /**
+     * @brief Reports a range that does not fit with an exception.
+     */
+    std::size_t fit_bulk(throw_on_overflow, const T *&first, std::size_t n, std::size_t) {
+        log(queue_event::rejected, first, n);
+        CQUEUE_THROW(std::overflow_error("Queue is full"));
+    }
+
+    /**
+     * @brief Constructs a new element in the slot after the current rear.
+     *
+     * The queue must not be full. The tail is only advanced once the element
+     * has been constructed successfully.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return A reference to the newly added element.
+     */
+    template<typename... Args>
+    T &construct_at_rear(Args &&... args) {
+        const std::size_t slot = slot_of(tail);
+        ::new(static_cast<void *>(arr + slot)) T(std::forward<Args>(args)...);
+        ++tail;
+
+        log(queue_event::enqueued, &arr[slot], 1);
+        return arr[slot];
+    }
+
+    /**
+     * @brief Destroys the front element and advances the head; the queue must not be empty.
+     */
+    void pop_front() noexcept {
+        arr[slot_of(head)].~T();
+        ++head;
+    }
+
+    /**
+     * @brief Maps a free-running counter to its slot in the storage.
+     *
+     * @param counter A head or tail position.
+     * @return The slot index.
+     */
+    std::size_t slot_of(std::uint64_t counter) const noexcept {
+        return static_cast<std::size_t>(counter & mask);
+    }
+
+    /**
+     * @brief Splits count consecutive slots starting at the given slot into contiguous spans.
+     *
+     * @param start The first slot.
+     * @param count The number of slots.
+     * @return The slots before and after the wrap point.
+     */
+    ring_span_pair<T> spans_from(std::size_t start, std::size_t count) const {
+        const std::size_t slots = mask + 1;
+        const std::size_t first_run = count < slots - start ? count : slots - start;
+        return ring_span_pair<T>(ring_span<T>(arr + start, first_run), ring_span<T>(arr, count - first_run));
+    }
+
+    /**
+     * @brief Destroys count consecutive elements starting at the given slot, without touching the indices.
+     *
+     * @param start The slot of the first element to destroy.
+     * @param count The number of elements to destroy.
+     */
+    void destroy_range(std::size_t start, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            arr[(start + i) & mask].~T();
+        }
+    }
+
+    /**
+     * @brief Destroys every element currently in the queue without touching the indices.
+     */
+    void destroy_elements() {
+        destroy_range(slot_of(head), get_size());
+    }
+
+    /**
+     * @brief Removes the given number of elements from the front of the queue.
+     *
+     * The removed elements are reported with the given event (overwritten by
+     * default), one event per contiguous run of slots.
+     *
+     * @param count The number of elements to discard; must not exceed the current size.
+     * @param event The event reported for the discarded elements.
+     */
+    void discard_front(std::size_t count, queue_event event = queue_event::overwritten) {
+        const std::size_t slots = mask + 1;
+        const std::size_t start = slot_of(head);
+        const std::size_t first_run = count < slots - start ? count : slots - start;
+        log(event, arr + start, first_run);
+        if (count > first_run) {
+            log(event, arr, count - first_run);
+        }
+        destroy_range(start, count);
+        if (event == queue_event::overwritten) {
+            dropped += count;
+        }
+        head += count;
+    }
+
+    /**
+     * @brief Destroys every element and frees the storage, if any.
+     */
+    void destroy_storage() {
+        if (arr) {
+            destroy_elements();
+            allocator_traits::deallocate(get_allocator(), arr, mask + 1);
+        }
+    }
+
+    /**
+     * @brief Leaves the queue without storage after its contents were moved elsewhere.
+     */
+    void release_storage() {
+        arr = nullptr;
+        head = tail = 0;
+        capacity = mask = 0;
+    }
+
+    /**
+     * @brief Returns the allocator that provides the storage.
+     *
+     * @return A reference to the allocator base.
+     */
+    Allocator &get_allocator() noexcept {
+        return static_cast<Allocator &>(*this);
+    }
+
+    /**
+     * @brief Reports an event to the logger policy.
+     *
+     * @param event The kind of event.
+     * @param values The affected value(s), or nullptr.
+     * @param count The number of values, or the event-specific quantity.
+     */
+    void log(queue_event event, const T *values, std::size_t count) {
+        static_cast<Logger &>(*this)(event, values, count);
+    }
+
 };
+
+#if defined(__cpp_lib_ranges)
+static_assert(std::ranges::random_access_range<circular_queue<int>>);
+static_assert(std::ranges::sized_range<const circular_queue<int>>);
+#endif
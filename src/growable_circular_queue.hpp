@@ -0,0 +1,297 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "queue_detail.hpp"
+
+/**
+ * @brief A circular queue that doubles its capacity instead of overwriting when it is full.
+ *
+ * Where circular_queue discards its oldest element on a full enqueue, this
+ * variant allocates a ring of twice the size and keeps every element. The
+ * elements of the old ring are not copied over in one go: the new ring keeps a
+ * gap in front of the newly enqueued elements for them, and every enqueue and
+ * dequeue moves up to migration_step of them from the back of the old ring
+ * into the end of that gap. Dequeues take from the front of the old ring while
+ * it still holds elements, so FIFO order is preserved throughout, and a growth
+ * costs one allocation plus a bounded amount of work per operation rather than
+ * an O(size) pause.
+ *
+ * Because the new ring is twice as large, migration always finishes before it
+ * can fill up again as long as migration_step is at least 1. Should it not
+ * (for instance after many dequeues that outpaced it), the remaining elements
+ * are moved before the next growth.
+ *
+ * Head and tail are free-running counters and the capacity is always a power
+ * of two, so a slot index is counter & mask.
+ *
+ * @tparam T The type of elements in the queue (e.g., int, std::string).
+ * @tparam Allocator The allocator that provides the ring storage.
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class growable_circular_queue : private Allocator {
+
+    static_assert(std::is_same<typename Allocator::value_type, T>::value, "Allocator::value_type must be T");
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same<typename allocator_traits::pointer, T *>::value, "Allocator must use raw pointers");
+
+    T *arr{};                           ///< Current ring storage
+    std::size_t mask{};                 ///< Index mask of the current ring
+    std::size_t head{}, tail{};         ///< Free-running counters; [head, tail) includes the migration gap
+
+    T *old_arr{};                       ///< Ring being migrated away from, or nullptr
+    std::size_t old_mask{};             ///< Index mask of the old ring
+    std::size_t old_head{}, old_tail{}; ///< Elements of the old ring still to be dequeued or migrated
+
+    std::size_t step{};                 ///< Elements migrated per operation
+
+public:
+
+    /**
+     * @brief Constructor that initializes the queue with an initial capacity.
+     *
+     * @param n The initial capacity; rounded up to a power of two.
+     * @param migration_step The number of elements moved out of an old ring per operation.
+     * @param allocator The allocator instance that provides the storage.
+     * @throws std::invalid_argument if n or migration_step is 0.
+     */
+    explicit growable_circular_queue(std::size_t n, std::size_t migration_step = 4,
+                                     const Allocator &allocator = Allocator())
+        : Allocator(allocator), step(migration_step) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        if (migration_step == 0) {
+            CQUEUE_THROW(std::invalid_argument("Migration step must be greater than 0."));
+        }
+        const std::size_t slots = cqueue_detail::next_power_of_two(n);
+        arr = allocator_traits::allocate(get_allocator(), slots);
+        mask = slots - 1;
+    }
+
+    growable_circular_queue(const growable_circular_queue &) = delete;
+    growable_circular_queue &operator=(const growable_circular_queue &) = delete;
+
+    /**
+     * @brief Move constructor that takes over the storage of another queue.
+     *
+     * The moved-from queue is left without storage and may only be destroyed.
+     *
+     * @param other The queue to move from.
+     */
+    growable_circular_queue(growable_circular_queue &&other) noexcept
+        : Allocator(std::move(other.get_allocator())), arr(other.arr), mask(other.mask), head(other.head),
+          tail(other.tail), old_arr(other.old_arr), old_mask(other.old_mask), old_head(other.old_head),
+          old_tail(other.old_tail), step(other.step) {
+        other.arr = other.old_arr = nullptr;
+        other.head = other.tail = other.old_head = other.old_tail = 0;
+    }
+
+    /**
+     * @brief Destroys the remaining elements and frees both rings.
+     */
+    ~growable_circular_queue() {
+        clear();
+        if (arr) {
+            allocator_traits::deallocate(get_allocator(), arr, mask + 1);
+        }
+    }
+
+    /**
+     * @brief Copies an element to the rear of the queue, growing it if it is full.
+     *
+     * @param value The element to be added to the queue.
+     */
+    void enqueue(const T &value) {
+        emplace(value);
+    }
+
+    /**
+     * @brief Moves an element to the rear of the queue, growing it if it is full.
+     *
+     * @param value The element to be moved into the queue.
+     */
+    void enqueue(T &&value) {
+        emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place at the rear of the queue, growing it if it is full.
+     *
+     * If the constructor of T throws, no element is added; the queue may still
+     * have grown.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return A reference to the newly added element.
+     * @throws std::length_error if the capacity cannot be doubled any further.
+     */
+    template<typename... Args>
+    T &emplace(Args &&... args) {
+        if (tail - head == mask + 1) {
+            grow();
+        }
+        T *slot = arr + (tail & mask);
+        ::new(static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+        ++tail;
+        migrate(step);
+        return *slot;
+    }
+
+    /**
+     * @brief Removes and returns the front element of the queue.
+     *
+     * @return The element removed from the front of the queue.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T dequeue() {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+
+        T *slot = front_slot();
+        T value = std::move(*slot);
+        slot->~T();
+        if (old_head != old_tail) {
+            ++old_head;
+            release_old_if_done();
+        }
+        ++head;
+        migrate(step);
+        return value;
+    }
+
+    /**
+     * @brief Returns the front element of the queue without removing it.
+     *
+     * @return A reference to the front element.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T &peek() {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return *front_slot();
+    }
+
+    /**
+     * @brief Removes all elements; the current capacity is kept.
+     */
+    void clear() {
+        for (; old_head != old_tail; ++old_head, ++head) {
+            old_arr[old_head & old_mask].~T();
+        }
+        release_old_if_done();
+        for (; head != tail; ++head) {
+            arr[head & mask].~T();
+        }
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return head == tail;
+    }
+
+    /**
+     * @brief Checks whether elements are still being moved out of a previous, smaller ring.
+     *
+     * @return True while a migration is in progress.
+     */
+    bool is_migrating() const {
+        return old_arr != nullptr;
+    }
+
+    /**
+     * @brief Returns the number of elements in the queue.
+     *
+     * @return The number of elements.
+     */
+    std::size_t get_size() const {
+        return tail - head;
+    }
+
+    /**
+     * @brief Returns the capacity the queue can reach before it grows again.
+     *
+     * @return The number of slots in the current ring.
+     */
+    std::size_t get_capacity() const {
+        return mask + 1;
+    }
+
+private:
+
+    /**
+     * @brief Returns the slot of the front element; the queue must not be empty.
+     */
+    T *front_slot() {
+        return old_head != old_tail ? old_arr + (old_head & old_mask) : arr + (head & mask);
+    }
+
+    /**
+     * @brief Switches to a ring of twice the capacity, leaving the current elements to be migrated.
+     */
+    void grow() {
+        migrate(old_tail - old_head);
+        const std::size_t slots = mask + 1;
+        if (slots > (static_cast<std::size_t>(-1) >> 1)) {
+            CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+        }
+        T *new_arr = allocator_traits::allocate(get_allocator(), slots * 2);
+
+        // The gap [head, tail) of the new ring is reserved for the elements left in the old one
+        old_arr = arr;
+        old_mask = mask;
+        old_head = head;
+        old_tail = tail;
+        arr = new_arr;
+        mask = slots * 2 - 1;
+    }
+
+    /**
+     * @brief Moves up to count elements from the back of the old ring into the end of the gap.
+     *
+     * @param count The maximum number of elements to move.
+     */
+    void migrate(std::size_t count) {
+        for (; count != 0 && old_head != old_tail; --count) {
+            T *source = old_arr + ((old_tail - 1) & old_mask);
+            ::new(static_cast<void *>(arr + ((head + (old_tail - 1 - old_head)) & mask)))
+                T(std::move_if_noexcept(*source));
+            source->~T();
+            --old_tail;
+        }
+        release_old_if_done();
+    }
+
+    /**
+     * @brief Frees the old ring once every element has left it.
+     */
+    void release_old_if_done() {
+        if (old_arr && old_head == old_tail) {
+            allocator_traits::deallocate(get_allocator(), old_arr, old_mask + 1);
+            old_arr = nullptr;
+            old_head = old_tail = 0;
+        }
+    }
+
+    /**
+     * @brief Returns the allocator that provides the storage.
+     *
+     * @return A reference to the allocator base.
+     */
+    Allocator &get_allocator() noexcept {
+        return static_cast<Allocator &>(*this);
+    }
+
+};
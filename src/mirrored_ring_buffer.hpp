@@ -0,0 +1,407 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <memoryapi.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "onecore.lib")
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Returns the granularity at which the mirrored mapping can be placed.
+     *
+     * @return The page size on POSIX systems, or the allocation granularity on Windows.
+     */
+    inline std::size_t mirror_granularity() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwAllocationGranularity);
+#else
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    /**
+     * @brief Maps a block of memory twice, back to back, in the virtual address space.
+     *
+     * After the call, the addresses [base, base + bytes) and [base + bytes, base + 2 * bytes)
+     * refer to the same physical memory.
+     *
+     * @param bytes The size of the block; must be a multiple of mirror_granularity().
+     * @return The base address of the double mapping.
+     * @throws std::system_error if the mapping cannot be created.
+     */
+    inline void *map_mirrored(std::size_t bytes) {
+#if defined(_WIN32)
+        const auto size = static_cast<unsigned long long>(bytes);
+        HANDLE section = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+        if (section == nullptr) {
+            CQUEUE_THROW(std::system_error(static_cast<int>(GetLastError()), std::system_category(), "CreateFileMapping failed"));
+        }
+
+        char *placeholder = static_cast<char *>(VirtualAlloc2(nullptr, nullptr, 2 * bytes,
+                                                              MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS,
+                                                              nullptr, 0));
+        if (placeholder == nullptr) {
+            const DWORD error = GetLastError();
+            CloseHandle(section);
+            CQUEUE_THROW(std::system_error(static_cast<int>(error), std::system_category(), "VirtualAlloc2 failed"));
+        }
+
+        // Split the reservation into two placeholders, one for each view
+        VirtualFree(placeholder, bytes, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER);
+
+        void *first = MapViewOfFile3(section, nullptr, placeholder, 0, bytes, MEM_REPLACE_PLACEHOLDER,
+                                     PAGE_READWRITE, nullptr, 0);
+        void *second = MapViewOfFile3(section, nullptr, placeholder + bytes, 0, bytes, MEM_REPLACE_PLACEHOLDER,
+                                      PAGE_READWRITE, nullptr, 0);
+        const DWORD error = GetLastError();
+        CloseHandle(section); // The views keep the section alive
+        if (first == nullptr || second == nullptr) {
+            if (first != nullptr) {
+                UnmapViewOfFile(first);
+            } else {
+                VirtualFree(placeholder, 0, MEM_RELEASE);
+            }
+            if (second != nullptr) {
+                UnmapViewOfFile(second);
+            } else {
+                VirtualFree(placeholder + bytes, 0, MEM_RELEASE);
+            }
+            CQUEUE_THROW(std::system_error(static_cast<int>(error), std::system_category(), "MapViewOfFile3 failed"));
+        }
+        return placeholder;
+#else
+#if defined(__linux__)
+        const int fd = memfd_create("cqueue_mirror", MFD_CLOEXEC);
+#else
+        // Create an anonymous POSIX shared memory object by unlinking it right away
+        char name[64];
+        std::snprintf(name, sizeof(name), "/cqueue_mirror_%ld_%p", static_cast<long>(getpid()),
+                      static_cast<void *>(&name));
+        const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd != -1) {
+            shm_unlink(name);
+        }
+#endif
+        if (fd == -1) {
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot create the ring memory object"));
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int error = errno;
+            close(fd);
+            CQUEUE_THROW(std::system_error(error, std::generic_category(), "Cannot size the ring memory object"));
+        }
+
+        void *reserved = mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved == MAP_FAILED) {
+            const int error = errno;
+            close(fd);
+            CQUEUE_THROW(std::system_error(error, std::generic_category(), "Cannot reserve address space for the ring"));
+        }
+
+        char *base = static_cast<char *>(reserved);
+        if (mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            const int error = errno;
+            munmap(base, 2 * bytes);
+            close(fd);
+            CQUEUE_THROW(std::system_error(error, std::generic_category(), "Cannot map the ring twice"));
+        }
+        close(fd); // The mappings keep the memory object alive
+        return base;
+#endif
+    }
+
+    /**
+     * @brief Releases a double mapping created by map_mirrored.
+     *
+     * @param base The base address returned by map_mirrored.
+     * @param bytes The size passed to map_mirrored.
+     */
+    inline void unmap_mirrored(void *base, std::size_t bytes) {
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+        UnmapViewOfFile(static_cast<char *>(base) + bytes);
+#else
+        munmap(base, 2 * bytes);
+#endif
+    }
+
+}
+
+/**
+ * @brief A ring buffer whose storage is mapped twice, back to back, in virtual memory.
+ *
+ * Because the second mapping aliases the first, the element after the last
+ * slot is the first slot again. Any window of up to get_capacity() elements
+ * starting anywhere in the ring is therefore a single contiguous pointer
+ * range: reads and writes never need to be split at the wrap point, element
+ * access needs no modulo, and SIMD parsers can run straight across the wrap.
+ *
+ * The storage is created with memfd_create (Linux), an unlinked shm_open
+ * object (other POSIX systems) or a pagefile-backed section mapped with
+ * MapViewOfFile3 into split placeholders (Windows 10 1803 or later). The
+ * capacity is rounded up so that the storage is a whole number of pages.
+ *
+ * Like circular_queue, this class is not thread-safe. A full buffer rejects
+ * new elements instead of overwriting the oldest ones.
+ *
+ * @tparam T The element type; must be trivially copyable (bytes or POD records).
+ */
+template<typename T>
+class mirrored_ring_buffer {
+
+    static_assert(std::is_trivially_copyable<T>::value, "mirrored_ring_buffer requires a trivially copyable type");
+
+    T *arr{};                                   ///< First of the two mappings; arr[capacity + i] aliases arr[i]
+    std::size_t bytes{};                        ///< Size of one mapping in bytes
+    std::size_t capacity{};                     ///< Number of elements in one mapping
+    std::size_t read_pos{}, size{};             ///< Offset of the front element and number of elements
+
+public:
+
+    /**
+     * @brief Constructor that maps the mirrored storage.
+     *
+     * @param n The minimum number of elements the buffer must hold.
+     * @throws std::invalid_argument if the given size is 0.
+     * @throws std::length_error if the two mappings for the given size cannot be addressed.
+     * @throws std::system_error if the operating system refuses the mapping.
+     */
+    explicit mirrored_ring_buffer(std::size_t n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+
+        // The mapping must be a whole number of pages and a whole number of elements
+        const std::size_t granularity = cqueue_detail::mirror_granularity();
+        std::size_t unit = granularity;
+        while (unit % sizeof(T) != 0) {
+            unit += granularity;
+        }
+        // Rounding up to the unit and reserving both mappings must not overflow
+        if (n > ((std::numeric_limits<std::size_t>::max() >> 1) - unit) / sizeof(T)) {
+            CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+        }
+        bytes = (n * sizeof(T) + unit - 1) / unit * unit;
+        capacity = bytes / sizeof(T);
+        arr = static_cast<T *>(cqueue_detail::map_mirrored(bytes));
+    }
+
+    mirrored_ring_buffer(const mirrored_ring_buffer &) = delete;
+    mirrored_ring_buffer &operator=(const mirrored_ring_buffer &) = delete;
+
+    /**
+     * @brief Move constructor that takes over the mapping of another buffer.
+     *
+     * @param other The buffer to move from; it is left without storage.
+     */
+    mirrored_ring_buffer(mirrored_ring_buffer &&other) noexcept
+        : arr(other.arr), bytes(other.bytes), capacity(other.capacity), read_pos(other.read_pos), size(other.size) {
+        other.arr = nullptr;
+        other.bytes = other.capacity = other.read_pos = other.size = 0;
+    }
+
+    /**
+     * @brief Destructor that releases the mapping.
+     */
+    ~mirrored_ring_buffer() {
+        if (arr) {
+            cqueue_detail::unmap_mirrored(arr, bytes);
+        }
+    }
+
+    /**
+     * @brief Reserves free space at the rear of the buffer for direct writing.
+     *
+     * @param n The maximum number of elements to reserve.
+     * @return A single contiguous span of up to n free slots.
+     */
+    ring_span<T> write_reserve(std::size_t n) {
+        const std::size_t room = capacity - size;
+        return ring_span<T>(arr + write_pos(), n < room ? n : room);
+    }
+
+    /**
+     * @brief Adds the first k slots of the preceding write_reserve to the buffer.
+     *
+     * @param k The number of slots that were written.
+     * @throws std::invalid_argument if k exceeds the free space of the buffer.
+     */
+    void write_commit(std::size_t k) {
+        if (k > capacity - size) {
+            CQUEUE_THROW(std::invalid_argument("Cannot commit more elements than were reserved"));
+        }
+        size += k;
+    }
+
+    /**
+     * @brief Exposes up to n elements at the front of the buffer for reading in place.
+     *
+     * @param n The maximum number of elements to expose.
+     * @return A single contiguous span of the front elements.
+     */
+    ring_span<T> read_peek(std::size_t n) {
+        return ring_span<T>(arr + read_pos, n < size ? n : size);
+    }
+
+    /**
+     * @brief Exposes up to n elements at the front of the buffer for reading in place.
+     *
+     * @param n The maximum number of elements to expose.
+     * @return A single contiguous span of the front elements.
+     */
+    ring_span<const T> read_peek(std::size_t n) const {
+        return ring_span<const T>(arr + read_pos, n < size ? n : size);
+    }
+
+    /**
+     * @brief Removes the first k elements of the buffer after they were read in place.
+     *
+     * @param k The number of elements to remove.
+     * @throws std::invalid_argument if k exceeds the current size.
+     */
+    void read_release(std::size_t k) {
+        if (k > size) {
+            CQUEUE_THROW(std::invalid_argument("Cannot release more elements than the buffer holds"));
+        }
+        read_pos += k;
+        if (read_pos >= capacity) {
+            read_pos -= capacity;
+        }
+        size -= k;
+    }
+
+    /**
+     * @brief Copies as many elements as fit to the rear of the buffer with a single memcpy.
+     *
+     * @param first Pointer to the first element to add.
+     * @param n The number of elements to add.
+     * @return The number of elements added.
+     */
+    std::size_t write(const T *first, std::size_t n) {
+        const ring_span<T> span = write_reserve(n);
+        if (!span.empty()) {
+            std::memcpy(span.data(), first, span.size() * sizeof(T));
+            size += span.size();
+        }
+        return span.size();
+    }
+
+    /**
+     * @brief Copies up to max elements out of the front of the buffer with a single memcpy and removes them.
+     *
+     * @param out Pointer to storage for at least max elements.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t read(T *out, std::size_t max) {
+        const ring_span<T> span = read_peek(max);
+        if (!span.empty()) {
+            std::memcpy(out, span.data(), span.size() * sizeof(T));
+            read_release(span.size());
+        }
+        return span.size();
+    }
+
+    /**
+     * @brief Returns the element at the given position from the front, without bounds checking.
+     *
+     * @param index The index of the element (0-based, relative to the front); must be less than get_size().
+     * @return A reference to the element.
+     */
+    T &operator[](std::size_t index) {
+        return arr[read_pos + index];
+    }
+
+    /**
+     * @brief Returns the element at the given position from the front, without bounds checking.
+     *
+     * @param index The index of the element (0-based, relative to the front); must be less than get_size().
+     * @return A reference to the element.
+     */
+    const T &operator[](std::size_t index) const {
+        return arr[read_pos + index];
+    }
+
+    /**
+     * @brief Removes every element from the buffer.
+     */
+    void clear() {
+        read_pos = size = 0;
+    }
+
+    /**
+     * @brief Checks if the buffer is empty.
+     *
+     * @return True if the buffer is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return size == 0;
+    }
+
+    /**
+     * @brief Checks if the buffer is full.
+     *
+     * @return True if the buffer is full, false otherwise.
+     */
+    bool is_full() const {
+        return size == capacity;
+    }
+
+    /**
+     * @brief Returns the number of elements in the buffer.
+     *
+     * @return The current size of the buffer.
+     */
+    std::size_t get_size() const {
+        return size;
+    }
+
+    /**
+     * @brief Returns the number of elements the buffer can hold.
+     *
+     * @return The capacity of the buffer, rounded up to whole pages.
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+private:
+
+    /**
+     * @brief Returns the offset of the first free slot.
+     *
+     * @return The slot after the last element, within the first mapping.
+     */
+    std::size_t write_pos() const {
+        const std::size_t pos = read_pos + size;
+        return pos >= capacity ? pos - capacity : pos;
+    }
+
+};
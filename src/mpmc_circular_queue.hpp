@@ -0,0 +1,370 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "queue_detail.hpp"
+#include "queue_wait.hpp"
+
+/**
+ * @brief A bounded lock-free multi-producer/multi-consumer circular queue.
+ *
+ * Any number of threads may call try_enqueue and try_dequeue concurrently.
+ * The implementation follows Dmitry Vyukov's bounded MPMC queue: every slot
+ * carries a sequence counter that tells producers when the slot is free for
+ * their lap of the ring and tells consumers when it has been filled. Threads
+ * claim a position with a single compare-and-swap on the shared enqueue or
+ * dequeue index and then work on their slot without further contention, so
+ * neither operation ever blocks or takes a lock.
+ *
+ * The slot array and capacity, the enqueue position and the dequeue position
+ * each sit on their own cache line. Because fullness and emptiness are read
+ * from the per-slot sequence counters, producers never load the dequeue
+ * position and consumers never load the enqueue position on the fast path.
+ *
+ * Like spsc_circular_queue, a full queue rejects new elements instead of
+ * overwriting the oldest one, and the requested capacity is rounded up to the
+ * next power of two, and to at least 2.
+ *
+ * Once a position has been claimed its slot must be filled, so the constructor
+ * of T used by an enqueue must not throw.
+ *
+ * With Blocking set to true the queue also offers wait_enqueue and
+ * wait_dequeue, which spin briefly and then park the calling thread until the
+ * other side makes progress or a timeout expires. Every successful operation
+ * then checks for parked threads with one fence and one load, and only issues
+ * a wake-up when a waiter is registered. With Blocking false (the default)
+ * that check compiles away.
+ *
+ * @tparam T The type of elements in the queue (e.g., int, std::string).
+ * @tparam Blocking Whether the queue supports the blocking wait_ operations.
+ */
+template<typename T, bool Blocking = false>
+class mpmc_circular_queue {
+
+    using event_type = typename std::conditional<Blocking, cqueue_detail::event_count,
+        cqueue_detail::null_event_count>::type;
+
+    /**
+     * @brief A single ring slot: the sequence counter followed by raw storage for one element.
+     */
+    struct cell {
+        std::atomic<std::size_t> sequence;                                  ///< Lap-tagged state of the slot
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; ///< Uninitialized element storage
+
+        T *value() {
+            return reinterpret_cast<T *>(&storage);
+        }
+    };
+
+    // Read-only after construction; kept off the lines the positions bounce on
+    alignas(cqueue_detail::cache_line_size) std::unique_ptr<cell[]> cells;  ///< Array that holds the queue slots
+    std::size_t capacity{}, mask{};                                         ///< Number of slots and index mask
+
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> enqueue_pos{0};  ///< Next position claimed by producers
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> dequeue_pos{0};  ///< Next position claimed by consumers
+
+    event_type not_empty;                                                   ///< Wakes consumers parked in wait_dequeue
+    event_type not_full;                                                    ///< Wakes producers parked in wait_enqueue
+
+public:
+
+    /**
+     * @brief Constructor that initializes the queue with a fixed size.
+     *
+     * @param n The minimum number of elements the queue must hold; rounded up to a power of two of at least 2.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit mpmc_circular_queue(std::size_t n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        // With one slot, a filled cell would already carry the next lap's sequence and look free
+        capacity = cqueue_detail::next_power_of_two(n < 2 ? 2 : n);
+        mask = capacity - 1;
+        cells.reset(new cell[capacity]);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_circular_queue(const mpmc_circular_queue &) = delete;
+    mpmc_circular_queue &operator=(const mpmc_circular_queue &) = delete;
+
+    /**
+     * @brief Destroys the remaining elements.
+     *
+     * Must not run concurrently with any producer or consumer.
+     */
+    ~mpmc_circular_queue() {
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        const std::size_t end = enqueue_pos.load(std::memory_order_relaxed);
+        for (; pos != end; ++pos) {
+            cells[pos & mask].value()->~T();
+        }
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue.
+     *
+     * @param value The element to be added to the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(const T &value) {
+        return try_emplace(value);
+    }
+
+    /**
+     * @brief Moves an element into the rear of the queue.
+     *
+     * @param value The element to be moved into the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place at the rear of the queue.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return True if the element was added, false if the queue is full.
+     */
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;) {
+            c = &cells[pos & mask];
+            const std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The slot still holds an element from the previous lap
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        ::new(static_cast<void *>(c->value())) T(std::forward<Args>(args)...);
+        c->sequence.store(pos + 1, std::memory_order_release);
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the front element of the queue.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool try_dequeue(T &out) {
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;) {
+            c = &cells[pos & mask];
+            const std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The slot has not been filled for this lap yet
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T *slot = c->value();
+        out = std::move(*slot);
+        slot->~T();
+        c->sequence.store(pos + capacity, std::memory_order_release);
+        not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Copies as many elements of a contiguous range as can be claimed at once.
+     *
+     * Consecutive free slots are claimed with a single compare-and-swap on the
+     * enqueue index, so a batch costs one contended index update instead of one
+     * per element. Each element is still copied into its own slot, because the
+     * sequence counters interleave with the element storage.
+     *
+     * @param first Pointer to the first element to add.
+     * @param n The number of elements to add.
+     * @return The number of elements added, which is less than n if the queue filled up.
+     */
+    std::size_t try_enqueue_bulk(const T *first, std::size_t n) {
+        const std::size_t limit = n < capacity ? n : capacity;
+        if (limit == 0) {
+            return 0;
+        }
+
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        std::size_t count;
+        for (;;) {
+            count = 0;
+            while (count < limit && cells[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count) {
+                ++count;
+            }
+            if (count == 0) {
+                const std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - pos) < 0) {
+                    return 0; // The queue is full
+                }
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            } else if (enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            cell &c = cells[(pos + i) & mask];
+            ::new(static_cast<void *>(c.value())) T(first[i]);
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        not_empty.notify_all();
+        return count;
+    }
+
+    /**
+     * @brief Removes as many elements, up to max, as can be claimed at once.
+     *
+     * Consecutive filled slots are claimed with a single compare-and-swap on the
+     * dequeue index; each slot is released back to the producers as soon as its
+     * element has been moved out.
+     *
+     * @param out Pointer to the first of at least max elements that receive the removed values.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t try_dequeue_bulk(T *out, std::size_t max) {
+        const std::size_t limit = max < capacity ? max : capacity;
+        if (limit == 0) {
+            return 0;
+        }
+
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        std::size_t count;
+        for (;;) {
+            count = 0;
+            while (count < limit && cells[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count + 1) {
+                ++count;
+            }
+            if (count == 0) {
+                const std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0) {
+                    return 0; // The queue is empty
+                }
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            } else if (dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            cell &c = cells[(pos + i) & mask];
+            T *slot = c.value();
+            out[i] = std::move(*slot);
+            slot->~T();
+            c.sequence.store(pos + i + capacity, std::memory_order_release);
+        }
+        not_full.notify_all();
+        return count;
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue, waiting while it is full.
+     *
+     * Spins for a bounded number of attempts and then parks the thread until a
+     * consumer frees a slot or the timeout expires. The value is only consumed
+     * if the call succeeds.
+     *
+     * @param value The element to be added to the queue.
+     * @param timeout The maximum time to wait.
+     * @return True if the element was added, false if the timeout expired.
+     */
+    template<typename U, typename Rep, typename Period>
+    bool wait_enqueue(U &&value, const std::chrono::duration<Rep, Period> &timeout) {
+        static_assert(Blocking, "wait_enqueue requires a queue with Blocking = true");
+        return cqueue_detail::spin_then_park(not_full, timeout, [&] {
+            return try_emplace(std::forward<U>(value));
+        });
+    }
+
+    /**
+     * @brief Removes the front element of the queue, waiting while it is empty.
+     *
+     * Spins for a bounded number of attempts and then parks the thread until a
+     * producer adds an element or the timeout expires.
+     *
+     * @param out Receives the removed element.
+     * @param timeout The maximum time to wait.
+     * @return True if an element was removed, false if the timeout expired.
+     */
+    template<typename Rep, typename Period>
+    bool wait_dequeue(T &out, const std::chrono::duration<Rep, Period> &timeout) {
+        static_assert(Blocking, "wait_dequeue requires a queue with Blocking = true");
+        return cqueue_detail::spin_then_park(not_empty, timeout, [&] {
+            return try_dequeue(out);
+        });
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return get_size() == 0;
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == capacity;
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in the queue.
+     *
+     * Counts claimed positions, so elements that are still being written or
+     * read by another thread are included.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        const std::size_t deq = dequeue_pos.load(std::memory_order_acquire);
+        const auto size = static_cast<std::ptrdiff_t>(enqueue_pos.load(std::memory_order_acquire) - deq);
+        if (size < 0) {
+            return 0;
+        }
+        return static_cast<std::size_t>(size) > capacity ? capacity : static_cast<std::size_t>(size);
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "queue_detail.hpp"
+
+/**
+ * @brief Scheduling policy that always serves the lowest-numbered non-empty lane.
+ *
+ * Lane 0 has the highest priority. A lower lane only runs when every lane
+ * above it is empty, so a busy high-priority lane can starve the others.
+ */
+struct strict_priority {
+};
+
+/**
+ * @brief Scheduling policy that serves the non-empty lanes in turn, each for up to its weight.
+ *
+ * A lane keeps the turn for up to weight consecutive dequeues, or until it
+ * runs empty; the turn then passes to the next non-empty lane in cyclic
+ * order. Over time, busy lanes therefore share the dequeues in proportion to
+ * their weights, and no lane starves.
+ */
+struct weighted_round_robin {
+};
+
+/**
+ * @brief A set of fixed-capacity FIFO lanes that are dequeued from in scheduled order.
+ *
+ * The lanes are rings of the same power-of-two capacity carved out of a single
+ * allocation, so a producer picks a lane per element and a consumer polls one
+ * object instead of several queues. A bitmap records which lanes hold
+ * elements; picking the next lane is a count-trailing-zeros on that bitmap,
+ * O(1) regardless of the number of lanes, and an empty queue is detected with
+ * a single compare.
+ *
+ * Like spsc_circular_queue, a full lane rejects new elements rather than
+ * overwriting, so backpressure on one lane never loses another lane's data.
+ * The class is not thread-safe.
+ *
+ * @tparam T The type of elements in the queue.
+ * @tparam Lanes The number of lanes (1 to 64).
+ * @tparam Schedule strict_priority (the default) or weighted_round_robin.
+ */
+template<typename T, std::size_t Lanes, typename Schedule = strict_priority>
+class multi_lane_queue {
+
+    static_assert(Lanes >= 1 && Lanes <= 64, "multi_lane_queue supports 1 to 64 lanes");
+    static_assert(std::is_same<Schedule, strict_priority>::value || std::is_same<Schedule, weighted_round_robin>::value,
+                  "Schedule must be strict_priority or weighted_round_robin");
+
+    /**
+     * @brief Free-running counters of one lane.
+     */
+    struct lane_state {
+        std::uint64_t head;     ///< Counter of removed elements
+        std::uint64_t tail;     ///< Counter of added elements
+    };
+
+    T *arr{};                                       ///< Storage of all lanes; lane i starts at arr + i * (mask + 1)
+    std::size_t mask{};                             ///< Index mask of one lane
+    std::uint64_t nonempty{};                       ///< Bit i is set while lane i holds elements
+    std::array<lane_state, Lanes> lanes{};          ///< Positions of each lane
+    std::array<std::uint32_t, Lanes> weights{};     ///< Turn length of each lane (weighted_round_robin)
+    std::size_t current{};                          ///< Lane holding the turn (weighted_round_robin)
+    std::uint32_t credit{};                         ///< Dequeues left in the current turn (weighted_round_robin)
+    std::allocator<T> allocator;                    ///< Allocator for the storage
+
+public:
+
+    /**
+     * @brief Constructor that creates empty lanes with every weight set to 1.
+     *
+     * @param n The minimum number of elements each lane must hold; rounded up to a power of two.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit multi_lane_queue(std::size_t n)
+        : multi_lane_queue(n, uniform_weights()) {
+    }
+
+    /**
+     * @brief Constructor that creates empty lanes with the given round-robin weights.
+     *
+     * @param n The minimum number of elements each lane must hold; rounded up to a power of two.
+     * @param lane_weights The number of consecutive dequeues each lane may take per turn; ignored by strict_priority.
+     * @throws std::invalid_argument if the given size or any weight is 0.
+     * @throws std::length_error if the storage for all lanes cannot be addressed.
+     */
+    multi_lane_queue(std::size_t n, const std::array<std::uint32_t, Lanes> &lane_weights)
+        : weights(lane_weights) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        for (const std::uint32_t weight : weights) {
+            if (weight == 0) {
+                CQUEUE_THROW(std::invalid_argument("Lane weights must be greater than 0."));
+            }
+        }
+        const std::size_t slots = cqueue_detail::next_power_of_two(n);
+        if (slots > static_cast<std::size_t>(-1) / sizeof(T) / Lanes) {
+            CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+        }
+        mask = slots - 1;
+        arr = allocator.allocate(slots * Lanes);
+        credit = weights[0];
+    }
+
+    multi_lane_queue(const multi_lane_queue &) = delete;
+    multi_lane_queue &operator=(const multi_lane_queue &) = delete;
+
+    /**
+     * @brief Destroys the remaining elements and releases the storage.
+     */
+    ~multi_lane_queue() {
+        clear();
+        allocator.deallocate(arr, (mask + 1) * Lanes);
+    }
+
+    /**
+     * @brief Adds an element to the rear of a lane.
+     *
+     * @param lane The lane to add to.
+     * @param value The element to be added.
+     * @return True if the element was added, false if the lane is full.
+     * @throws std::out_of_range if lane is not less than Lanes.
+     */
+    bool enqueue(std::size_t lane, const T &value) {
+        return emplace(lane, value);
+    }
+
+    /**
+     * @brief Moves an element into the rear of a lane.
+     *
+     * @param lane The lane to add to.
+     * @param value The element to be moved in; left untouched if the lane is full.
+     * @return True if the element was added, false if the lane is full.
+     * @throws std::out_of_range if lane is not less than Lanes.
+     */
+    bool enqueue(std::size_t lane, T &&value) {
+        return emplace(lane, std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place at the rear of a lane.
+     *
+     * @param lane The lane to add to.
+     * @param args Arguments forwarded to the constructor of T.
+     * @return True if the element was added, false if the lane is full.
+     * @throws std::out_of_range if lane is not less than Lanes.
+     */
+    template<typename... Args>
+    bool emplace(std::size_t lane, Args &&... args) {
+        if (lane >= Lanes) {
+            CQUEUE_THROW(std::out_of_range("Lane out of range"));
+        }
+        lane_state &state = lanes[lane];
+        if (state.tail - state.head > mask) {
+            return false;
+        }
+        ::new(static_cast<void *>(slot(lane, state.tail))) T(std::forward<Args>(args)...);
+        ++state.tail;
+        nonempty |= std::uint64_t(1) << lane;
+        return true;
+    }
+
+    /**
+     * @brief Removes the next element in scheduled order.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if every lane is empty.
+     */
+    bool try_dequeue(T &out) {
+        std::size_t lane;
+        return try_dequeue(out, lane);
+    }
+
+    /**
+     * @brief Removes the next element in scheduled order and reports its lane.
+     *
+     * @param out Receives the removed element.
+     * @param lane Receives the lane the element was taken from.
+     * @return True if an element was removed, false if every lane is empty.
+     */
+    bool try_dequeue(T &out, std::size_t &lane) {
+        if (nonempty == 0) {
+            return false;
+        }
+        lane = pick(Schedule());
+        lane_state &state = lanes[lane];
+        T *element = slot(lane, state.head);
+        out = std::move(*element);
+        element->~T();
+        if (++state.head == state.tail) {
+            nonempty &= ~(std::uint64_t(1) << lane);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes and returns the next element in scheduled order.
+     *
+     * @return The removed element.
+     * @throws std::underflow_error if every lane is empty.
+     */
+    T dequeue() {
+        if (nonempty == 0) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        const std::size_t lane = pick(Schedule());
+        lane_state &state = lanes[lane];
+        T *element = slot(lane, state.head);
+        T value = std::move(*element);
+        element->~T();
+        if (++state.head == state.tail) {
+            nonempty &= ~(std::uint64_t(1) << lane);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Destroys every element in every lane.
+     */
+    void clear() {
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            lane_state &state = lanes[lane];
+            for (; state.head != state.tail; ++state.head) {
+                slot(lane, state.head)->~T();
+            }
+        }
+        nonempty = 0;
+    }
+
+    /**
+     * @brief Checks if every lane is empty.
+     *
+     * @return True if the queue holds no elements, false otherwise.
+     */
+    bool is_empty() const {
+        return nonempty == 0;
+    }
+
+    /**
+     * @brief Checks if a lane is full.
+     *
+     * @param lane The lane to check; must be less than Lanes.
+     * @return True if the lane cannot take another element, false otherwise.
+     */
+    bool is_full(std::size_t lane) const {
+        return get_size(lane) == get_capacity();
+    }
+
+    /**
+     * @brief Returns the number of elements in a lane.
+     *
+     * @param lane The lane to check; must be less than Lanes.
+     * @return The current size of the lane.
+     */
+    std::size_t get_size(std::size_t lane) const {
+        return static_cast<std::size_t>(lanes[lane].tail - lanes[lane].head);
+    }
+
+    /**
+     * @brief Returns the number of elements in all lanes together.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        std::size_t size = 0;
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            size += get_size(lane);
+        }
+        return size;
+    }
+
+    /**
+     * @brief Returns the capacity of each lane.
+     *
+     * @return The number of elements one lane can hold (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Returns the number of lanes.
+     *
+     * @return Lanes.
+     */
+    static constexpr std::size_t get_lane_count() {
+        return Lanes;
+    }
+
+private:
+
+    static std::array<std::uint32_t, Lanes> uniform_weights() {
+        std::array<std::uint32_t, Lanes> result;
+        result.fill(1);
+        return result;
+    }
+
+    /**
+     * @brief Returns the storage for a position of a lane.
+     */
+    T *slot(std::size_t lane, std::uint64_t counter) const {
+        return arr + lane * (mask + 1) + static_cast<std::size_t>(counter & mask);
+    }
+
+    /**
+     * @brief Picks the highest-priority non-empty lane; some lane must be non-empty.
+     */
+    std::size_t pick(strict_priority) const {
+        return cqueue_detail::count_trailing_zeros(nonempty);
+    }
+
+    /**
+     * @brief Picks the lane holding the turn, passing the turn on when it is used up or the lane is empty.
+     */
+    std::size_t pick(weighted_round_robin) {
+        if (credit == 0 || (nonempty & (std::uint64_t(1) << current)) == 0) {
+            // The first non-empty lane after the current one, wrapping around
+            const std::uint64_t after = current + 1 < 64 ? nonempty & (~std::uint64_t(0) << (current + 1)) : 0;
+            current = cqueue_detail::count_trailing_zeros(after != 0 ? after : nonempty);
+            credit = weights[current];
+        }
+        --credit;
+        return current;
+    }
+
+};
@@ -0,0 +1,530 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_WIN32)
+#error "persistent_circular_queue requires POSIX mmap and msync"
+#endif
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "queue_detail.hpp"
+
+/**
+ * @brief When a persistent_circular_queue forces its changes to stable storage.
+ *
+ * Every mode survives a crash of the process: the file is a shared mapping,
+ * so the kernel keeps the written pages. The modes differ in what survives a
+ * crash of the operating system or a power loss.
+ */
+enum class durability {
+    none,       ///< Never sync; the kernel writes pages back on its own schedule. sync() still works.
+    per_batch,  ///< Sync at the end of every bulk operation and on sync(); single operations are as exposed as with none.
+    per_op      ///< Sync after every operation that changes the queue.
+};
+
+namespace cqueue_detail {
+
+    /**
+     * @brief The on-disk header of a persistent_circular_queue, stored in the first page of the file.
+     *
+     * Every field is 8-byte aligned and the whole header fits in one 512-byte
+     * sector, so head and tail are never torn by a partial write.
+     */
+    struct persistent_header {
+        std::uint64_t magic;            ///< persistent_magic once the file is fully initialized
+        std::uint32_t version;          ///< Layout version of the file
+        std::uint32_t element_size;     ///< sizeof(T) of the queue that created the file
+        std::uint64_t element_align;    ///< alignof(T) of the queue that created the file
+        std::uint64_t capacity;         ///< Number of slots (a power of two)
+        std::uint64_t head;             ///< Free-running counter of the front element
+        std::uint64_t tail;             ///< Free-running counter of the next free slot
+    };
+
+    constexpr std::uint64_t persistent_magic = 0x4555455551435043ULL;    ///< "CPCQUEUE" in little-endian
+    constexpr std::uint32_t persistent_version = 1;
+
+    /**
+     * @brief Flushes the pages covering a byte range of a file mapping to stable storage.
+     *
+     * @param base The page-aligned start of the mapping.
+     * @param offset Offset of the first byte to flush.
+     * @param bytes Number of bytes to flush.
+     * @param page The page size.
+     * @throws std::system_error if msync fails.
+     */
+    inline void sync_mapping(char *base, std::size_t offset, std::size_t bytes, std::size_t page) {
+        if (bytes == 0) {
+            return;
+        }
+        const std::size_t first = offset / page * page;
+        if (msync(base + first, offset + bytes - first, MS_SYNC) != 0) {
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot sync the queue file"));
+        }
+    }
+
+}
+
+/**
+ * @brief A circular queue whose slots and indices live in a memory-mapped file.
+ *
+ * The file holds a one-page header (magic, version, element layout,
+ * capacity, head and tail) followed by the slots. Because the queue is the
+ * file, there is nothing to serialize: opening an existing file validates
+ * the header and maps it, in O(1) and without replaying or copying the
+ * data.
+ *
+ * Elements are written before the tail that publishes them, and every sync
+ * flushes the slots written since the last one before the header. After an
+ * operating-system crash or a power loss, every element enqueued before the
+ * last sync is therefore intact. Operations that do not sync (every
+ * operation with durability::none, and single enqueue and dequeue with
+ * per_batch) leave the write-back order to the kernel, which may write the
+ * header page before a slot page, so after a power loss their slots can be
+ * stale behind an already written tail. Use per_op, or call sync() after the
+ * single operations that must survive.
+ *
+ * The file is locked with flock while it is open, so a second process (or a
+ * second queue in the same process) cannot open it concurrently. Like
+ * circular_queue, the class is not thread-safe, and like mirrored_ring_buffer
+ * a full queue rejects new elements instead of overwriting the oldest ones.
+ *
+ * @tparam T The element type; must be trivially copyable, since its bytes are stored as they are.
+ */
+template<typename T>
+class persistent_circular_queue {
+
+    static_assert(std::is_trivially_copyable<T>::value, "persistent_circular_queue requires a trivially copyable type");
+    static_assert(alignof(T) <= 4096, "persistent_circular_queue requires an alignment of at most one page");
+
+    int fd{-1};                                 ///< The open, locked queue file
+    char *base{};                               ///< Start of the file mapping
+    std::size_t bytes{};                        ///< Size of the file mapping
+    std::size_t page{};                         ///< Page size; the slots start one page into the file
+    cqueue_detail::persistent_header *header{}; ///< The header at the start of the mapping
+    T *arr{};                                   ///< The slots, after the header page
+    std::size_t mask{};                         ///< Index mask of the slots
+    std::uint64_t synced_tail{};                ///< Tail as of the last sync; the slots after it may be unflushed
+    durability mode{};                          ///< When changes are synced
+    bool recovered{};                           ///< Whether the file already held a queue when opened
+
+public:
+
+    /**
+     * @brief Constructor that opens a queue file, creating and initializing it if needed.
+     *
+     * If the file already holds a queue, its elements, indices and capacity are
+     * used as they are and n is ignored.
+     * An empty file, or one left behind by an interrupted creation, is initialized
+     * as a new queue; any other file without a queue header is refused.
+     *
+     * @param path Path of the queue file.
+     * @param n The minimum number of elements of a new queue; rounded up to a power of two.
+     * @param mode When changes are forced to stable storage.
+     * @throws std::invalid_argument if the given size is 0.
+     * @throws std::system_error if the file cannot be opened, locked, sized, mapped or synced.
+     * @throws std::runtime_error if the file is not a queue file, or holds a queue with a different layout or a corrupt header.
+     */
+    persistent_circular_queue(const std::string &path, std::size_t n, durability mode = durability::per_batch)
+        : page(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))), mode(mode) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot open the queue file " + path));
+        }
+        // The destructor does not run for a constructor that throws, so the file and mapping are released here
+        CQUEUE_TRY {
+            if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+                fail(errno, "Cannot lock the queue file " + path);
+            }
+
+            struct stat info {};
+            if (fstat(fd, &info) != 0) {
+                fail(errno, "Cannot inspect the queue file " + path);
+            }
+
+            const std::size_t file_size = static_cast<std::size_t>(info.st_size);
+            cqueue_detail::persistent_header existing{};
+            const bool readable = file_size >= sizeof(existing) &&
+                                  pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing));
+            const bool has_header = readable && existing.magic == cqueue_detail::persistent_magic;
+
+            // Only an empty file, or one whose creation was interrupted before the magic went in, is initialized
+            if (!has_header && file_size != 0 && !(readable && existing.magic == 0 && is_interrupted_creation(file_size))) {
+                CQUEUE_THROW(std::runtime_error("The file is not a queue file " + path));
+            }
+            const std::size_t capacity = has_header ? static_cast<std::size_t>(existing.capacity)
+                                                    : cqueue_detail::next_power_of_two(n);
+            if (has_header) {
+                validate(existing, file_size);
+            } else if (capacity > (std::numeric_limits<std::size_t>::max() - page) / sizeof(T)) {
+                CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+            }
+            bytes = page + capacity * sizeof(T);
+            if (!has_header && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                fail(errno, "Cannot size the queue file " + path);
+            }
+
+            void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) {
+                fail(errno, "Cannot map the queue file " + path);
+            }
+            base = static_cast<char *>(mapping);
+            header = reinterpret_cast<cqueue_detail::persistent_header *>(base);
+            arr = reinterpret_cast<T *>(base + page);
+            mask = capacity - 1;
+            recovered = has_header;
+            synced_tail = header->tail;
+
+            if (!has_header) {
+                header->version = cqueue_detail::persistent_version;
+                header->element_size = static_cast<std::uint32_t>(sizeof(T));
+                header->element_align = alignof(T);
+                header->capacity = capacity;
+                header->head = header->tail = 0;
+                // The magic goes in last so that a half-initialized file is recognized as new
+                sync_header();
+                header->magic = cqueue_detail::persistent_magic;
+                sync_header();
+            }
+        } CQUEUE_CATCH_ALL {
+            release();
+            CQUEUE_RETHROW;
+        }
+    }
+
+    persistent_circular_queue(const persistent_circular_queue &) = delete;
+    persistent_circular_queue &operator=(const persistent_circular_queue &) = delete;
+
+    /**
+     * @brief Move constructor that takes over the file and mapping of another queue.
+     *
+     * @param other The queue to move from; it is left without a file.
+     */
+    persistent_circular_queue(persistent_circular_queue &&other) noexcept
+        : fd(other.fd), base(other.base), bytes(other.bytes), page(other.page), header(other.header),
+          arr(other.arr), mask(other.mask), synced_tail(other.synced_tail), mode(other.mode), recovered(other.recovered) {
+        other.fd = -1;
+        other.base = nullptr;
+        other.header = nullptr;
+        other.arr = nullptr;
+    }
+
+    /**
+     * @brief Destructor that unmaps and unlocks the file.
+     *
+     * Pending changes are not synced; with durability::none or per_batch call
+     * sync() first if they must survive an operating-system crash.
+     */
+    ~persistent_circular_queue() {
+        release();
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue.
+     *
+     * @param value The element to be added to the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool enqueue(const T &value) {
+        const std::uint64_t t = header->tail;
+        if (t - header->head > mask) {
+            return false;
+        }
+        std::memcpy(static_cast<void *>(arr + (t & mask)), &value, sizeof(T));
+        publish_tail(t, 1, mode == durability::per_op);
+        return true;
+    }
+
+    /**
+     * @brief Copies as many elements of a contiguous range as fit into the queue.
+     *
+     * The elements are copied in at most two runs and published with a single
+     * tail update; with durability::per_batch or per_op they are synced once.
+     *
+     * @param first Pointer to the first element to add.
+     * @param n The number of elements to add.
+     * @return The number of elements added, which is less than n if the queue filled up.
+     */
+    std::size_t enqueue_bulk(const T *first, std::size_t n) {
+        const std::uint64_t t = header->tail;
+        const std::size_t room = get_capacity() - get_size();
+        const std::size_t count = n < room ? n : room;
+        if (count == 0) {
+            return 0;
+        }
+        const std::size_t start = slot_of(t);
+        const std::size_t first_run = count < get_capacity() - start ? count : get_capacity() - start;
+        std::memcpy(static_cast<void *>(arr + start), first, first_run * sizeof(T));
+        std::memcpy(static_cast<void *>(arr), first + first_run, (count - first_run) * sizeof(T));
+        publish_tail(t, count, mode != durability::none);
+        return count;
+    }
+
+    /**
+     * @brief Removes and returns the front element of the queue.
+     *
+     * @return The front element.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T dequeue() {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        const T value = read_front();
+        advance_head(1, mode == durability::per_op);
+        return value;
+    }
+
+    /**
+     * @brief Removes the front element of the queue if there is one.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool try_dequeue(T &out) {
+        if (is_empty()) {
+            return false;
+        }
+        std::memcpy(static_cast<void *>(&out), arr + slot_of(header->head), sizeof(T));
+        advance_head(1, mode == durability::per_op);
+        return true;
+    }
+
+    /**
+     * @brief Copies up to max elements out of the front of the queue and removes them.
+     *
+     * @param out Pointer to storage for at least max elements.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t dequeue_bulk(T *out, std::size_t max) {
+        const std::size_t size = get_size();
+        const std::size_t count = max < size ? max : size;
+        if (count == 0) {
+            return 0;
+        }
+        const std::size_t start = slot_of(header->head);
+        const std::size_t first_run = count < get_capacity() - start ? count : get_capacity() - start;
+        std::memcpy(static_cast<void *>(out), arr + start, first_run * sizeof(T));
+        std::memcpy(static_cast<void *>(out + first_run), arr, (count - first_run) * sizeof(T));
+        advance_head(count, mode != durability::none);
+        return count;
+    }
+
+    /**
+     * @brief Returns the front element of the queue without removing it.
+     *
+     * @return A copy of the front element.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T peek() const {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return read_front();
+    }
+
+    /**
+     * @brief Removes every element from the queue.
+     *
+     * Synced unless the durability is durability::none.
+     */
+    void clear() {
+        header->head = header->tail;
+        if (mode != durability::none) {
+            sync_header();
+        }
+    }
+
+    /**
+     * @brief Forces every slot and the header to stable storage, whatever the durability mode.
+     *
+     * @throws std::system_error if msync fails.
+     */
+    void sync() {
+        cqueue_detail::sync_mapping(base, page, bytes - page, page);
+        sync_header();
+        synced_tail = header->tail;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return header->head == header->tail;
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == get_capacity();
+    }
+
+    /**
+     * @brief Returns the number of elements currently in the queue.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        return static_cast<std::size_t>(header->tail - header->head);
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Returns when the queue forces its changes to stable storage.
+     *
+     * @return The durability mode passed to the constructor.
+     */
+    durability get_durability() const {
+        return mode;
+    }
+
+    /**
+     * @brief Checks whether the queue was recovered from an existing file.
+     *
+     * @return True if the file already held a queue when it was opened, false if it was created.
+     */
+    bool was_recovered() const {
+        return recovered;
+    }
+
+private:
+
+    /**
+     * @brief Maps a free-running counter to its slot.
+     */
+    std::size_t slot_of(std::uint64_t counter) const {
+        return static_cast<std::size_t>(counter & mask);
+    }
+
+    /**
+     * @brief Copies the bytes of the front element out of its slot, so T need not be default constructible.
+     */
+    T read_front() const {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type raw;
+        std::memcpy(static_cast<void *>(&raw), arr + slot_of(header->head), sizeof(T));
+        return *reinterpret_cast<const T *>(&raw);
+    }
+
+    /**
+     * @brief Publishes count elements written from counter t, syncing the slots before the tail if requested.
+     */
+    void publish_tail(std::uint64_t t, std::size_t count, bool durable) {
+        if (durable) {
+            // Also flush slots left by earlier unsynced enqueues, which the new tail publishes as well
+            const std::uint64_t unsynced = t + count - synced_tail;
+            const std::size_t flush = unsynced < get_capacity() ? static_cast<std::size_t>(unsynced) : get_capacity();
+            const std::size_t start = slot_of(t + count - flush);
+            const std::size_t first_run = flush < get_capacity() - start ? flush : get_capacity() - start;
+            cqueue_detail::sync_mapping(base, page + start * sizeof(T), first_run * sizeof(T), page);
+            cqueue_detail::sync_mapping(base, page, (flush - first_run) * sizeof(T), page);
+        }
+        header->tail = t + count;
+        if (durable) {
+            sync_header();
+            synced_tail = header->tail;
+        }
+    }
+
+    /**
+     * @brief Removes count elements from the front, syncing the header if requested.
+     */
+    void advance_head(std::size_t count, bool durable) {
+        header->head += count;
+        if (durable) {
+            sync_header();
+        }
+    }
+
+    void sync_header() {
+        cqueue_detail::sync_mapping(base, 0, sizeof(cqueue_detail::persistent_header), page);
+    }
+
+    /**
+     * @brief Checks whether a file without the magic has the size of a queue file whose creation was interrupted.
+     *
+     * Such a file was already sized to one header page plus a power-of-two number of slots.
+     */
+    bool is_interrupted_creation(std::size_t file_size) const {
+        if (file_size <= page || (file_size - page) % sizeof(T) != 0) {
+            return false;
+        }
+        return cqueue_detail::is_power_of_two((file_size - page) / sizeof(T));
+    }
+
+    /**
+     * @brief Checks that an existing header describes a queue of T that fits in the file.
+     */
+    void validate(const cqueue_detail::persistent_header &existing, std::size_t file_size) {
+        if (existing.version != cqueue_detail::persistent_version ||
+            existing.element_size != sizeof(T) || existing.element_align != alignof(T)) {
+            fail_layout("The queue file was created for a different element type or version");
+        }
+        // Bound the capacity before multiplying, so a corrupt header cannot wrap the size check
+        const std::uint64_t capacity = existing.capacity;
+        if (capacity == 0 || capacity > (std::numeric_limits<std::size_t>::max() - page) / sizeof(T) ||
+            capacity > file_size / sizeof(T) || !cqueue_detail::is_power_of_two(static_cast<std::size_t>(capacity)) ||
+            existing.tail - existing.head > capacity ||
+            file_size < page + static_cast<std::size_t>(capacity) * sizeof(T)) {
+            fail_layout("The queue file is truncated or its header is corrupt");
+        }
+    }
+
+    /**
+     * @brief Unmaps the file and closes it, which also releases the lock.
+     */
+    void release() noexcept {
+        if (base) {
+            munmap(base, bytes);
+            base = nullptr;
+        }
+        if (fd != -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    /**
+     * @brief Reports an operating-system error from the constructor, which then releases the file.
+     */
+    void fail(int error, const std::string &what) {
+        CQUEUE_THROW(std::system_error(error, std::generic_category(), what));
+    }
+
+    /**
+     * @brief Reports an incompatible or corrupt header from the constructor, which then releases the file.
+     */
+    void fail_layout(const char *what) {
+        CQUEUE_THROW(std::runtime_error(what));
+    }
+
+};
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "queue_detail.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Size of a transparent or explicit huge page on the platforms we target.
+     */
+    constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    /**
+     * @brief Rounds a byte count up to a multiple of the given alignment.
+     *
+     * @param bytes The byte count.
+     * @param alignment The alignment; must be a power of two.
+     * @return The rounded byte count.
+     */
+    constexpr std::size_t round_up(std::size_t bytes, std::size_t alignment) {
+        return (bytes + alignment - 1) & ~(alignment - 1);
+    }
+
+    /**
+     * @brief Touches every page of a block so it is faulted in now rather than on first use.
+     *
+     * @param memory The start of the block.
+     * @param bytes The size of the block.
+     * @param page The page size to step by.
+     */
+    inline void prefault(void *memory, std::size_t bytes, std::size_t page = 4096) {
+        volatile unsigned char *bytes_ptr = static_cast<unsigned char *>(memory);
+        for (std::size_t offset = 0; offset < bytes; offset += page) {
+            bytes_ptr[offset] = 0;
+        }
+    }
+
+#if defined(__linux__)
+    /**
+     * @brief Maps anonymous, page-aligned memory.
+     *
+     * @param bytes The size of the mapping.
+     * @param flags Extra mmap flags.
+     * @return The mapping, or nullptr on failure.
+     */
+    inline void *map_anonymous(std::size_t bytes, int flags) {
+        void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+#endif
+
+}
+
+/**
+ * @brief Allocator that backs a queue with 2 MB huge pages.
+ *
+ * On Linux the storage is first requested from the hugetlbfs pool with
+ * MAP_HUGETLB. If no explicit huge pages are reserved, a 2 MB aligned block is
+ * mapped instead and marked with MADV_HUGEPAGE so transparent huge pages can
+ * back it. Either way the block is pre-faulted at allocation time, so the
+ * first writes after startup do not take page faults or TLB misses per 4 KB.
+ * Elsewhere the allocator falls back to std::allocator.
+ *
+ * @tparam T The element type.
+ */
+template<typename T>
+class huge_page_allocator {
+
+public:
+
+    using value_type = T;
+
+    huge_page_allocator() = default;
+
+    template<typename U>
+    huge_page_allocator(const huge_page_allocator<U> &) noexcept {
+    }
+
+    /**
+     * @brief Allocates storage for n elements, rounded up to whole huge pages.
+     *
+     * @param n The number of elements.
+     * @return Pointer to the first element.
+     * @throws std::bad_alloc if no memory is available.
+     */
+    T *allocate(std::size_t n) {
+#if defined(__linux__)
+        const std::size_t bytes = cqueue_detail::round_up(n * sizeof(T), cqueue_detail::huge_page_size);
+        void *memory = cqueue_detail::map_anonymous(bytes, MAP_HUGETLB | MAP_POPULATE);
+        if (memory == nullptr) {
+            // No hugetlbfs pages reserved: align a regular mapping to 2 MB and ask for transparent huge pages
+            const std::size_t padded = bytes + cqueue_detail::huge_page_size;
+            auto *raw = static_cast<unsigned char *>(cqueue_detail::map_anonymous(padded, 0));
+            if (raw == nullptr) {
+                CQUEUE_THROW(std::bad_alloc());
+            }
+            const auto address = reinterpret_cast<std::uintptr_t>(raw);
+            auto *aligned = reinterpret_cast<unsigned char *>(
+                cqueue_detail::round_up(address, cqueue_detail::huge_page_size));
+            const std::size_t head = static_cast<std::size_t>(aligned - raw);
+            if (head != 0) {
+                munmap(raw, head);
+            }
+            munmap(aligned + bytes, padded - head - bytes);
+            madvise(aligned, bytes, MADV_HUGEPAGE);
+            cqueue_detail::prefault(aligned, bytes);
+            memory = aligned;
+        }
+        return static_cast<T *>(memory);
+#else
+        return std::allocator<T>().allocate(n);
+#endif
+    }
+
+    /**
+     * @brief Releases storage obtained from allocate.
+     *
+     * @param p Pointer returned by allocate.
+     * @param n The number of elements passed to allocate.
+     */
+    void deallocate(T *p, std::size_t n) noexcept {
+#if defined(__linux__)
+        munmap(p, cqueue_detail::round_up(n * sizeof(T), cqueue_detail::huge_page_size));
+#else
+        std::allocator<T>().deallocate(p, n);
+#endif
+    }
+
+    template<typename U>
+    bool operator==(const huge_page_allocator<U> &) const noexcept {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const huge_page_allocator<U> &) const noexcept {
+        return false;
+    }
+
+};
+
+/**
+ * @brief Allocator that places a queue's storage on a specific NUMA node.
+ *
+ * On Linux the storage is mapped page-aligned, bound to the node with the
+ * mbind system call (no libnuma dependency) and pre-faulted, so every page is
+ * already resident on that node before the queue is used. Pin the consumer of
+ * the queue to the same node to keep its reads local. Elsewhere the allocator
+ * falls back to std::allocator.
+ *
+ * @tparam T The element type.
+ */
+template<typename T>
+class numa_allocator {
+
+    template<typename U>
+    friend class numa_allocator;
+
+    int node{};                 ///< NUMA node the storage is bound to
+
+public:
+
+    using value_type = T;
+
+    /**
+     * @brief Constructor that selects the NUMA node.
+     *
+     * @param node The node to allocate on.
+     */
+    explicit numa_allocator(int node = 0) noexcept
+        : node(node) {
+    }
+
+    template<typename U>
+    numa_allocator(const numa_allocator<U> &other) noexcept
+        : node(other.node) {
+    }
+
+    /**
+     * @brief Allocates storage for n elements on the selected node.
+     *
+     * @param n The number of elements.
+     * @return Pointer to the first element.
+     * @throws std::bad_alloc if no memory is available or the node cannot be used.
+     */
+    T *allocate(std::size_t n) {
+#if defined(__linux__)
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t bytes = cqueue_detail::round_up(n * sizeof(T), page);
+        void *memory = cqueue_detail::map_anonymous(bytes, 0);
+        if (memory == nullptr) {
+            CQUEUE_THROW(std::bad_alloc());
+        }
+
+        constexpr int mpol_bind = 2;            // MPOL_BIND from <linux/mempolicy.h>
+        constexpr unsigned mpol_mf_move = 2;    // MPOL_MF_MOVE
+        constexpr std::size_t bits = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask(static_cast<std::size_t>(node) / bits + 1, 0);
+        mask[static_cast<std::size_t>(node) / bits] = 1UL << (static_cast<std::size_t>(node) % bits);
+        if (syscall(SYS_mbind, memory, bytes, mpol_bind, mask.data(), mask.size() * bits + 1, mpol_mf_move) != 0) {
+            munmap(memory, bytes);
+            CQUEUE_THROW(std::bad_alloc());
+        }
+        cqueue_detail::prefault(memory, bytes, page);
+        return static_cast<T *>(memory);
+#else
+        return std::allocator<T>().allocate(n);
+#endif
+    }
+
+    /**
+     * @brief Releases storage obtained from allocate.
+     *
+     * @param p Pointer returned by allocate.
+     * @param n The number of elements passed to allocate.
+     */
+    void deallocate(T *p, std::size_t n) noexcept {
+#if defined(__linux__)
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        munmap(p, cqueue_detail::round_up(n * sizeof(T), page));
+#else
+        std::allocator<T>().deallocate(p, n);
+#endif
+    }
+
+    /**
+     * @brief Returns the NUMA node this allocator binds to.
+     *
+     * @return The node number.
+     */
+    int get_node() const noexcept {
+        return node;
+    }
+
+    template<typename U>
+    bool operator==(const numa_allocator<U> &other) const noexcept {
+        return node == other.node;
+    }
+
+    template<typename U>
+    bool operator!=(const numa_allocator<U> &other) const noexcept {
+        return node != other.node;
+    }
+
+};
+
+/**
+ * @brief A caller-provided block of memory that arena_allocator carves queue storage from.
+ *
+ * The arena never owns its buffer: it can be a static array, a region inside
+ * a larger mapping, or memory obtained from huge_page_allocator. Allocations
+ * are cache-line aligned and bumped from the front; only the most recent
+ * allocation can be given back, so the space of storage replaced by
+ * circular_queue::resize is not reused until reset is called.
+ */
+class queue_arena {
+
+    unsigned char *buffer{};        ///< Start of the caller's block
+    std::size_t capacity{};         ///< Size of the caller's block in bytes
+    std::size_t used{};             ///< Bytes handed out so far
+    std::size_t last{};             ///< Offset of the most recent allocation
+
+public:
+
+    /**
+     * @brief Constructor that wraps a caller-provided block.
+     *
+     * @param memory The block to allocate from; must outlive every queue that uses it.
+     * @param bytes The size of the block.
+     */
+    queue_arena(void *memory, std::size_t bytes) noexcept
+        : buffer(static_cast<unsigned char *>(memory)), capacity(bytes) {
+    }
+
+    queue_arena(const queue_arena &) = delete;
+    queue_arena &operator=(const queue_arena &) = delete;
+
+    /**
+     * @brief Carves an aligned block from the arena.
+     *
+     * @param bytes The size of the block.
+     * @param alignment The required alignment; must be a power of two.
+     * @return Pointer to the block.
+     * @throws std::bad_alloc if the arena is exhausted.
+     */
+    void *allocate(std::size_t bytes, std::size_t alignment) {
+        if (alignment < cqueue_detail::cache_line_size) {
+            alignment = cqueue_detail::cache_line_size;
+        }
+        const auto base = reinterpret_cast<std::uintptr_t>(buffer);
+        const std::size_t offset = cqueue_detail::round_up(base + used, alignment) - base;
+        if (offset > capacity || bytes > capacity - offset) {
+            CQUEUE_THROW(std::bad_alloc());
+        }
+        last = offset;
+        used = offset + bytes;
+        return buffer + offset;
+    }
+
+    /**
+     * @brief Returns a block to the arena if it is the most recent allocation.
+     *
+     * @param memory Pointer returned by allocate.
+     */
+    void deallocate(void *memory) noexcept {
+        if (static_cast<unsigned char *>(memory) == buffer + last) {
+            used = last;
+        }
+    }
+
+    /**
+     * @brief Touches every page of the arena so it is faulted in before use.
+     */
+    void prefault() noexcept {
+        cqueue_detail::prefault(buffer, capacity);
+    }
+
+    /**
+     * @brief Forgets every allocation; only safe once all queues using the arena are gone.
+     */
+    void reset() noexcept {
+        used = last = 0;
+    }
+
+    /**
+     * @brief Returns the number of bytes still available.
+     *
+     * @return The free space at the end of the arena, before alignment.
+     */
+    std::size_t get_available() const noexcept {
+        return capacity - used;
+    }
+
+};
+
+/**
+ * @brief Allocator that takes queue storage from a queue_arena.
+ *
+ * @tparam T The element type.
+ */
+template<typename T>
+class arena_allocator {
+
+    template<typename U>
+    friend class arena_allocator;
+
+    queue_arena *arena;             ///< The arena storage is taken from
+
+public:
+
+    using value_type = T;
+
+    /**
+     * @brief Constructor that selects the arena.
+     *
+     * @param arena The arena to allocate from; must outlive the allocator and its allocations.
+     */
+    explicit arena_allocator(queue_arena &arena) noexcept
+        : arena(&arena) {
+    }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U> &other) noexcept
+        : arena(other.arena) {
+    }
+
+    /**
+     * @brief Allocates storage for n elements from the arena.
+     *
+     * @param n The number of elements.
+     * @return Pointer to the first element.
+     * @throws std::bad_alloc if the arena is exhausted.
+     */
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Returns storage to the arena.
+     *
+     * @param p Pointer returned by allocate.
+     */
+    void deallocate(T *p, std::size_t) noexcept {
+        arena->deallocate(p);
+    }
+
+    template<typename U>
+    bool operator==(const arena_allocator<U> &other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const arena_allocator<U> &other) const noexcept {
+        return arena != other.arena;
+    }
+
+};
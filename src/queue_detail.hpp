@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CQUEUE_EXCEPTIONS 1
+#else
+#define CQUEUE_EXCEPTIONS 0
+#endif
+
+/**
+ * @brief Error reporting that also compiles with exceptions disabled (-fno-exceptions).
+ *
+ * With exceptions enabled these expand to throw, try, catch (...) and a
+ * rethrow. Without them, a throw becomes std::abort() and the cleanup in a
+ * catch block is dropped, since nothing can be thrown that would reach it.
+ * The exception expression stays as an unevaluated sizeof operand, so the
+ * error codes and messages it is built from still count as used.
+ * Code that builds without exceptions should use the try_ operations, which
+ * report failure through their return value.
+ */
+#if CQUEUE_EXCEPTIONS
+#define CQUEUE_THROW(exception) throw exception
+#define CQUEUE_TRY try
+#define CQUEUE_CATCH_ALL catch (...)
+#define CQUEUE_RETHROW throw
+#else
+#define CQUEUE_THROW(exception) ((void) sizeof(exception), std::abort())
+#define CQUEUE_TRY if (true)
+#define CQUEUE_CATCH_ALL else
+#define CQUEUE_RETHROW ((void) 0)
+#endif
+
+/**
+ * @brief Destructive-interference size used to separate data written by different threads.
+ *
+ * Defaults to 128 bytes where the hardware transfers lines in 128-byte units
+ * (Apple silicon and POWER) and to 64 bytes elsewhere. Define it before
+ * including any queue header to override the default, for example to 128 on
+ * x86 parts whose adjacent-line prefetcher pulls in pairs of 64-byte lines.
+ */
+#ifndef CQUEUE_CACHE_LINE_SIZE
+#if (defined(__APPLE__) && defined(__aarch64__)) || defined(__powerpc64__)
+#define CQUEUE_CACHE_LINE_SIZE 128
+#else
+#define CQUEUE_CACHE_LINE_SIZE 64
+#endif
+#endif
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <optional>
+#define CQUEUE_HAS_OPTIONAL 1
+#else
+#define CQUEUE_HAS_OPTIONAL 0
+#endif
+
+// C++20 coroutines, for async_queue.hpp; checked in two steps for preprocessors without __has_include
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#if __has_include(<coroutine>)
+#define CQUEUE_HAS_COROUTINES 1
+#endif
+#endif
+#ifndef CQUEUE_HAS_COROUTINES
+#define CQUEUE_HAS_COROUTINES 0
+#endif
+
+/**
+ * @brief Internal helpers shared by the circular queue variants.
+ *
+ * Nothing in this namespace is part of the public interface; it collects the
+ * small constants and bit tricks that several queue headers rely on.
+ */
+namespace cqueue_detail {
+
+    /**
+     * @brief Size assumed for a destructive-interference cache line (see CQUEUE_CACHE_LINE_SIZE).
+     *
+     * Concurrent variants place their producer-owned state, consumer-owned
+     * state and read-only configuration on separate lines of this size, so the
+     * two sides never write to the same line.
+     */
+    constexpr std::size_t cache_line_size = CQUEUE_CACHE_LINE_SIZE;
+
+    static_assert(cache_line_size != 0 && (cache_line_size & (cache_line_size - 1)) == 0,
+                  "CQUEUE_CACHE_LINE_SIZE must be a power of two");
+
+    /**
+     * @brief Checks whether a value is a non-zero power of two.
+     *
+     * @param n The value to check.
+     * @return True if n is a power of two, false otherwise.
+     */
+    constexpr bool is_power_of_two(std::size_t n) {
+        return n != 0 && (n & (n - 1)) == 0;
+    }
+
+    /**
+     * @brief Rounds a value up to the next power of two.
+     *
+     * @param n The value to round up (must be greater than 0).
+     * @return The smallest power of two that is greater than or equal to n.
+     * @throws std::length_error if no such power of two fits in std::size_t.
+     */
+    inline std::size_t next_power_of_two(std::size_t n) {
+        if (n > (std::numeric_limits<std::size_t>::max() >> 1) + 1) {
+            CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+        }
+        std::size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the index of the lowest set bit.
+     *
+     * @param bits The value to scan; must not be 0.
+     * @return The number of trailing zero bits.
+     */
+    inline unsigned count_trailing_zeros(std::uint64_t bits) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<unsigned>(index);
+#else
+        unsigned index = 0;
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * @brief The header that circular_queue::snapshot writes before the elements.
+     *
+     * The elements follow as raw bytes, front first. All fields are in the
+     * byte order of the machine that wrote the snapshot.
+     */
+    struct snapshot_header {
+        std::uint64_t magic;            ///< snapshot_magic
+        std::uint32_t version;          ///< Layout version of the snapshot
+        std::uint32_t element_size;     ///< sizeof(T) of the queue that wrote the snapshot
+        std::uint64_t count;            ///< Number of elements that follow
+    };
+
+    constexpr std::uint64_t snapshot_magic = 0x313050414E535143ULL;      ///< "CQSNAP01" in little-endian
+    constexpr std::uint32_t snapshot_version = 1;
+
+}
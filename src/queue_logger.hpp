@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Events reported to a queue logger policy.
+ */
+enum class queue_event {
+    enqueued,       ///< Elements were added; `values` points to the `count` added elements
+    dequeued,       ///< Elements were removed; `values` points to the `count` removed elements
+    overwritten,    ///< Elements were discarded to make room; `values` points to the `count` discarded elements
+    dropped,        ///< New elements were discarded because the queue was full (or a bulk range exceeded the capacity); `values` points to them, or is nullptr if they were never constructed
+    rejected,       ///< New elements were refused because the queue was full and stay with the caller; `values` points to them, or is nullptr if they were never constructed
+    cleared,        ///< The queue was cleared; `count` is the number of discarded elements
+    resized,        ///< The queue was resized; `count` is the new capacity
+    full,           ///< An add found the queue without enough room, before the overflow policy applied; `count` is 0
+    empty           ///< A remove found the queue empty; `count` is 0
+};
+
+/**
+ * @brief Logger policy that discards every event.
+ *
+ * This is the default policy of circular_queue. The call operator is an empty
+ * inline function, so logging compiles away entirely and, thanks to the empty
+ * base optimization, the policy takes no space in the queue.
+ */
+struct no_log {
+
+    /**
+     * @brief Ignores the event.
+     */
+    template<typename T>
+    void operator()(queue_event, const T *, std::size_t) const noexcept {
+    }
+
+};
+
+/**
+ * @brief Logger policy that forwards structured events to a callback.
+ *
+ * The callback receives the event code, a pointer to the affected value(s)
+ * (or nullptr for events about the queue itself) and a count. No string is
+ * formatted and nothing is allocated when an event is reported.
+ *
+ * @tparam T The element type of the queue being logged.
+ */
+template<typename T>
+class event_log {
+
+    std::function<void(queue_event, const T *, std::size_t)> callback;    ///< Callback receiving the events
+
+public:
+
+    /**
+     * @brief Constructor that registers the event callback.
+     *
+     * @param callback Any callable accepting (queue_event, const T*, std::size_t).
+     */
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, event_log>::value>::type>
+    event_log(F &&callback)
+        : callback(std::forward<F>(callback)) {
+    }
+
+    event_log() = default;
+
+    /**
+     * @brief Forwards the event to the callback, if one is registered.
+     *
+     * @param event The kind of event.
+     * @param values The affected value(s), or nullptr.
+     * @param count The number of values, or the event-specific quantity.
+     */
+    void operator()(queue_event event, const T *values, std::size_t count) const {
+        if (callback) {
+            callback(event, values, count);
+        }
+    }
+
+};
+
+/**
+ * @brief Logger policy that formats each event as a human-readable message.
+ *
+ * This keeps the message-based logging of earlier versions available. Values
+ * are written with operator<<, so the element type must be streamable, and a
+ * std::string is built for every event: prefer event_log on hot paths. The
+ * full and empty conditions are not reported.
+ */
+class string_log {
+
+    std::function<void(const std::string &)> callback;    ///< Callback receiving the formatted messages
+
+public:
+
+    /**
+     * @brief Constructor that registers the message callback.
+     *
+     * @param callback Any callable accepting a const std::string&.
+     */
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, string_log>::value>::type>
+    string_log(F &&callback)
+        : callback(std::forward<F>(callback)) {
+    }
+
+    string_log() = default;
+
+    /**
+     * @brief Formats the event and passes the message to the callback.
+     *
+     * @param event The kind of event.
+     * @param values The affected value(s), or nullptr.
+     * @param count The number of values, or the event-specific quantity.
+     */
+    template<typename T>
+    void operator()(queue_event event, const T *values, std::size_t count) const {
+        if (!callback) {
+            return;
+        }
+
+        std::ostringstream message;
+        switch (event) {
+            case queue_event::enqueued:
+                message << "Enqueued:";
+                break;
+            case queue_event::dequeued:
+                message << "Dequeued:";
+                break;
+            case queue_event::overwritten:
+                message << "Overwritten:";
+                break;
+            case queue_event::dropped:
+                if (values == nullptr) {
+                    message << "Dropped " << count << " element(s)";
+                    callback(message.str());
+                    return;
+                }
+                message << "Dropped:";
+                break;
+            case queue_event::rejected:
+                if (values == nullptr) {
+                    message << "Rejected " << count << " element(s)";
+                    callback(message.str());
+                    return;
+                }
+                message << "Rejected:";
+                break;
+            case queue_event::cleared:
+                callback("Queue cleared");
+                return;
+            case queue_event::resized:
+                message << "Queue resized to capacity: " << count;
+                callback(message.str());
+                return;
+            case queue_event::full:
+            case queue_event::empty:
+                // Conditions rather than changes; a polling consumer would flood the log
+                return;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            message << ' ' << values[i];
+        }
+        callback(message.str());
+    }
+
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * @brief Overflow policies that decide what circular_queue does with an element that does not fit.
+ *
+ * The policy is a compile-time template argument, so the choice costs no
+ * branch beyond the full check every enqueue already performs. Every policy
+ * makes enqueue return whether the element was stored.
+ *
+ * There is deliberately no blocking policy: circular_queue is not thread-safe,
+ * so nothing could make room while an enqueue waits. Producers that need
+ * blocking backpressure use wait_enqueue of spsc_circular_queue or
+ * mpmc_circular_queue with Blocking set to true.
+ */
+
+/**
+ * @brief Overwrites the oldest element to make room (the default).
+ *
+ * Enqueue always succeeds. Each overwritten element is reported as
+ * queue_event::overwritten and counted by get_dropped_count. The leading
+ * elements of an enqueue_bulk range longer than the capacity never enter the
+ * queue; they are reported as queue_event::dropped and counted as well.
+ */
+struct overwrite_oldest {
+};
+
+/**
+ * @brief Refuses the new element and leaves it with the caller.
+ *
+ * Enqueue returns false and an rvalue argument is not moved from, so the
+ * caller can retry, reroute or apply backpressure. The element is reported as
+ * queue_event::rejected but not counted by get_dropped_count, since it is not
+ * lost.
+ */
+struct reject_newest {
+};
+
+/**
+ * @brief Discards the new element and counts it.
+ *
+ * Enqueue returns false. Each discarded element is reported as
+ * queue_event::dropped and counted by get_dropped_count, which makes this
+ * the policy for shedding load while keeping track of how much was shed.
+ */
+struct drop_newest {
+};
+
+/**
+ * @brief Throws std::overflow_error instead of storing the new element.
+ *
+ * The element is reported as queue_event::rejected before the exception is thrown.
+ */
+struct throw_on_overflow {
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_WIN32)
+#error "queue_snapshot.hpp requires POSIX writev and readv"
+#endif
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+namespace cqueue_detail {
+
+    constexpr std::size_t io_batch = 16;    ///< Chunks handed to one writev or readv call
+
+    /**
+     * @brief Drops the first bytes from an array of iovecs, after a partial writev or readv.
+     *
+     * @param iov The array; advanced past the fully transferred entries.
+     * @param count The number of entries; reduced accordingly.
+     * @param bytes The number of bytes that were transferred.
+     */
+    inline void advance_iovecs(iovec *&iov, int &count, std::size_t bytes) {
+        while (count > 0 && bytes >= iov->iov_len) {
+            bytes -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + bytes;
+            iov->iov_len -= bytes;
+        }
+    }
+
+    /**
+     * @brief Fills an array of iovecs from up to io_batch chunks.
+     *
+     * @return The number of entries filled.
+     */
+    template<typename Byte>
+    int fill_iovecs(iovec *iov, const ring_span<Byte> *chunks, std::size_t count) {
+        int filled = 0;
+        for (std::size_t i = 0; i < count && i < io_batch; ++i) {
+            iov[filled].iov_base = const_cast<unsigned char *>(chunks[i].data());
+            iov[filled].iov_len = chunks[i].size();
+            ++filled;
+        }
+        return filled;
+    }
+
+}
+
+/**
+ * @brief A snapshot writer for circular_queue::snapshot that writes to a file descriptor.
+ *
+ * All chunks of a snapshot go to the kernel in one writev straight from the
+ * queue's storage, and partial writes are continued until every byte is
+ * written, so checkpointing costs the write itself and no copy in user space.
+ * The descriptor must be in blocking mode.
+ */
+struct fd_writer {
+    int fd;     ///< The descriptor to write to
+
+    /**
+     * @brief Writes every chunk, in order.
+     *
+     * @throws std::system_error if writev fails.
+     */
+    void operator()(const ring_span<const unsigned char> *chunks, std::size_t count) const {
+        while (count != 0) {
+            iovec batch[cqueue_detail::io_batch];
+            int pending = cqueue_detail::fill_iovecs(batch, chunks, count);
+            chunks += pending;
+            count -= static_cast<std::size_t>(pending);
+
+            iovec *iov = batch;
+            cqueue_detail::advance_iovecs(iov, pending, 0);     // Skips empty chunks
+            while (pending > 0) {
+                const ssize_t written = ::writev(fd, iov, pending);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot write the snapshot"));
+                }
+                cqueue_detail::advance_iovecs(iov, pending, static_cast<std::size_t>(written));
+            }
+        }
+    }
+};
+
+/**
+ * @brief A snapshot reader for circular_queue::restore that reads from a file descriptor.
+ *
+ * The elements are read with readv straight into the free slots of the queue.
+ * The descriptor must be in blocking mode.
+ */
+struct fd_reader {
+    int fd;     ///< The descriptor to read from
+
+    /**
+     * @brief Fills every chunk, in order.
+     *
+     * @throws std::system_error if readv fails.
+     * @throws std::invalid_argument if the data ends before every chunk is filled.
+     */
+    void operator()(const ring_span<unsigned char> *chunks, std::size_t count) const {
+        while (count != 0) {
+            iovec batch[cqueue_detail::io_batch];
+            int pending = cqueue_detail::fill_iovecs(batch, chunks, count);
+            chunks += pending;
+            count -= static_cast<std::size_t>(pending);
+
+            iovec *iov = batch;
+            cqueue_detail::advance_iovecs(iov, pending, 0);
+            while (pending > 0) {
+                const ssize_t read = ::readv(fd, iov, pending);
+                if (read < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot read the snapshot"));
+                }
+                if (read == 0) {
+                    CQUEUE_THROW(std::invalid_argument("Snapshot is truncated"));
+                }
+                cqueue_detail::advance_iovecs(iov, pending, static_cast<std::size_t>(read));
+            }
+        }
+    }
+};
+
+/**
+ * @brief Moves every element of a queue to a file descriptor as raw bytes, front first.
+ *
+ * Each round hands the front elements to writev as at most two runs that
+ * point straight into the queue, and releases the elements that were written
+ * in full, so slots are freed while the transfer is still going. A pipe or
+ * socket on the other end gets the bytes with the kernel's single copy.
+ * Unlike snapshot, no header is written, which suits streaming the elements
+ * to a consumer that knows their type.
+ *
+ * The queue must offer read_peek returning a ring_span_pair and read_release,
+ * like circular_queue, and must not be modified by anyone else during the
+ * call. The descriptor must be in blocking mode.
+ *
+ * @param queue The queue to drain.
+ * @param fd The descriptor to write to.
+ * @return The number of elements written and removed.
+ * @throws std::system_error if writev fails; the elements written in full are removed and the rest stay in the queue, while the stream may end in part of an element.
+ */
+template<typename Queue>
+std::size_t drain_to(Queue &queue, int fd) {
+    using value_type = typename Queue::value_type;
+    static_assert(std::is_trivially_copyable<value_type>::value, "drain_to requires a trivially copyable type");
+
+    std::size_t drained = 0;
+    std::size_t partial = 0;    // Bytes of the front element that are already written
+    while (!queue.is_empty()) {
+        const auto elements = queue.read_peek(queue.get_size());
+        iovec iov[2];
+        int count = 0;
+        iov[count].iov_base = reinterpret_cast<unsigned char *>(elements.first.data()) + partial;
+        iov[count].iov_len = elements.first.size() * sizeof(value_type) - partial;
+        ++count;
+        if (!elements.second.empty()) {
+            iov[count].iov_base = elements.second.data();
+            iov[count].iov_len = elements.second.size() * sizeof(value_type);
+            ++count;
+        }
+
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot drain the queue"));
+        }
+        const std::size_t bytes = partial + static_cast<std::size_t>(written);
+        queue.read_release(bytes / sizeof(value_type));
+        drained += bytes / sizeof(value_type);
+        partial = bytes % sizeof(value_type);
+    }
+    return drained;
+}
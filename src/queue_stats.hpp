@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "queue_logger.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Reads a cheap, monotonically increasing timestamp.
+     *
+     * @return The time stamp counter on x86, the virtual counter (CNTVCT_EL0) on
+     *         AArch64, and steady_clock nanoseconds elsewhere.
+     */
+    inline std::uint64_t read_timestamp() noexcept {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+        std::uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Returns the index of the highest set bit, treating 0 like 1.
+     *
+     * @param n The value.
+     * @return floor(log2(n)) for n > 0, and 0 for n == 0.
+     */
+    inline std::size_t log2_floor(std::uint64_t n) noexcept {
+        n |= 1;
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(63 - __builtin_clzll(n));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, n);
+        return static_cast<std::size_t>(index);
+#else
+        std::size_t index = 0;
+        while (n >>= 1) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * @brief Adds to a counter that only one thread writes.
+     *
+     * A relaxed load and store instead of fetch_add: the owning thread needs no
+     * locked instruction, and other threads still read a whole value.
+     */
+    inline void bump(std::atomic<std::uint64_t> &counter, std::uint64_t n) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+}
+
+/**
+ * @brief A point-in-time copy of the counters kept by stats_log.
+ */
+struct queue_stats {
+    std::uint64_t enqueued{};           ///< Elements added
+    std::uint64_t dequeued{};           ///< Elements removed by the consumer
+    std::uint64_t overwritten{};        ///< Elements discarded from the queue to make room
+    std::uint64_t dropped{};            ///< New elements discarded because the queue was full
+    std::uint64_t rejected{};           ///< New elements refused because the queue was full
+    std::uint64_t cleared{};            ///< Elements discarded by clear
+    std::uint64_t full_hits{};          ///< Add operations that found the queue full
+    std::uint64_t empty_hits{};         ///< Remove operations that found the queue empty
+    std::uint64_t size{};               ///< Number of elements in the queue
+    std::uint64_t high_water_mark{};    ///< Largest number of elements the queue has held
+
+    std::uint64_t residency_samples{};  ///< Number of sampled elements that were dequeued
+    /// Bucket i counts sampled elements that stayed between 2^i and 2^(i+1) timestamp ticks (see read_timestamp)
+    std::array<std::uint64_t, 64> residency_histogram{};
+};
+
+/**
+ * @brief Logger policy that maintains queue health counters for export, such as to Prometheus.
+ *
+ * Every event updates a few counters with relaxed atomic loads and stores, so
+ * the hot path costs a handful of plain memory operations and no locked
+ * instructions, and the counters can be read from any other thread with
+ * stats() while the queue is in use. The queue itself is still used by one
+ * thread at a time; that thread is the only writer of the counters.
+ *
+ * With SampleEvery set to N > 0, every N-th added element is also tagged with
+ * read_timestamp(). When a tagged element is dequeued, the time it spent in
+ * the queue is added to a log2 histogram; tagged elements that are
+ * overwritten or cleared are not counted. Up to 64 tagged elements are in
+ * flight at once, and elements that would exceed that are not tagged.
+ *
+ * @tparam SampleEvery Tag every N-th added element for the residency histogram; 0 disables it.
+ */
+template<std::size_t SampleEvery = 0>
+class stats_log {
+
+    static constexpr std::size_t sample_slots = 64;     ///< Capacity of the in-flight sample ring
+
+    /**
+     * @brief A tagged element: its position in the stream of added elements and when it was added.
+     */
+    struct sample {
+        std::uint64_t pos;
+        std::uint64_t timestamp;
+    };
+
+    std::atomic<std::uint64_t> enqueued{0}, dequeued{0}, overwritten{0}, dropped{0}, rejected{0}, cleared{0};
+    std::atomic<std::uint64_t> full_hits{0}, empty_hits{0};
+    std::atomic<std::uint64_t> high_water_mark{0};
+    std::atomic<std::uint64_t> residency_samples{0};
+    std::array<std::atomic<std::uint64_t>, 64> residency_histogram{};
+
+    // Writer-only state
+    std::uint64_t live{};                               ///< Number of elements in the queue
+    std::uint64_t added{}, removed{};                   ///< Positions of the next added and next removed element
+    std::uint64_t next_sample{};                        ///< Position of the next element to tag
+    std::array<sample, sample_slots> samples{};         ///< Tagged elements still in the queue, oldest first
+    std::size_t sample_head{}, sample_tail{};           ///< Free-running indices into samples
+
+public:
+
+    stats_log() = default;
+
+    /**
+     * @brief Copies the counters of another policy, for example when a queue is constructed from it.
+     */
+    stats_log(const stats_log &other) noexcept {
+        copy_from(other);
+    }
+
+    stats_log &operator=(const stats_log &other) noexcept {
+        if (this != &other) {
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Updates the counters for an event.
+     *
+     * @param event The kind of event.
+     * @param count The number of affected elements, or the event-specific quantity.
+     */
+    template<typename T>
+    void operator()(queue_event event, const T *, std::size_t count) noexcept {
+        const std::uint64_t n = count;
+        switch (event) {
+            case queue_event::enqueued: {
+                cqueue_detail::bump(enqueued, n);
+                live += n;
+                if (live > high_water_mark.load(std::memory_order_relaxed)) {
+                    high_water_mark.store(live, std::memory_order_relaxed);
+                }
+                tag_added(n);
+                break;
+            }
+            case queue_event::dequeued:
+                cqueue_detail::bump(dequeued, n);
+                remove(n, true);
+                break;
+            case queue_event::overwritten:
+                cqueue_detail::bump(overwritten, n);
+                remove(n, false);
+                break;
+            case queue_event::cleared:
+                cqueue_detail::bump(cleared, n);
+                remove(n, false);
+                break;
+            case queue_event::dropped:
+                cqueue_detail::bump(dropped, n);
+                break;
+            case queue_event::rejected:
+                cqueue_detail::bump(rejected, n);
+                break;
+            case queue_event::full:
+                cqueue_detail::bump(full_hits, 1);
+                break;
+            case queue_event::empty:
+                cqueue_detail::bump(empty_hits, 1);
+                break;
+            case queue_event::resized:
+                break;
+        }
+    }
+
+    /**
+     * @brief Returns a copy of the counters. Safe to call from any thread.
+     *
+     * @return The counters as of the call; fields are read one at a time, so
+     *         a snapshot taken during an operation may mix before and after values.
+     */
+    queue_stats stats() const noexcept {
+        queue_stats snapshot;
+        snapshot.enqueued = enqueued.load(std::memory_order_relaxed);
+        snapshot.dequeued = dequeued.load(std::memory_order_relaxed);
+        snapshot.overwritten = overwritten.load(std::memory_order_relaxed);
+        snapshot.dropped = dropped.load(std::memory_order_relaxed);
+        snapshot.rejected = rejected.load(std::memory_order_relaxed);
+        snapshot.cleared = cleared.load(std::memory_order_relaxed);
+        snapshot.full_hits = full_hits.load(std::memory_order_relaxed);
+        snapshot.empty_hits = empty_hits.load(std::memory_order_relaxed);
+        // Derived rather than stored, which saves the writer a counter update per event
+        const std::uint64_t removed_total = snapshot.dequeued + snapshot.overwritten + snapshot.cleared;
+        snapshot.size = snapshot.enqueued > removed_total ? snapshot.enqueued - removed_total : 0;
+        snapshot.high_water_mark = high_water_mark.load(std::memory_order_relaxed);
+        snapshot.residency_samples = residency_samples.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < residency_histogram.size(); ++i) {
+            snapshot.residency_histogram[i] = residency_histogram[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+private:
+
+    /**
+     * @brief Advances the added position and tags the elements that fall on a sample point.
+     */
+    void tag_added(std::uint64_t n) noexcept {
+        if (SampleEvery == 0) {
+            return;
+        }
+        const std::uint64_t end = added + n;
+        if (next_sample < end) {
+            const std::uint64_t now = cqueue_detail::read_timestamp();
+            for (; next_sample < end; next_sample += SampleEvery) {
+                if (sample_tail - sample_head < sample_slots) {
+                    samples[sample_tail++ % sample_slots] = sample{next_sample, now};
+                }
+            }
+        }
+        added = end;
+    }
+
+    /**
+     * @brief Advances the removed position, recording the residency of tagged elements that were dequeued.
+     */
+    void remove(std::uint64_t n, bool consumed) noexcept {
+        live -= n;
+        if (SampleEvery == 0) {
+            return;
+        }
+        removed += n;
+        std::uint64_t timestamp = 0;
+        for (; sample_head != sample_tail && samples[sample_head % sample_slots].pos < removed; ++sample_head) {
+            if (consumed) {
+                if (timestamp == 0) {
+                    timestamp = cqueue_detail::read_timestamp();
+                }
+                const std::uint64_t residency = timestamp - samples[sample_head % sample_slots].timestamp;
+                cqueue_detail::bump(residency_histogram[cqueue_detail::log2_floor(residency)], 1);
+                cqueue_detail::bump(residency_samples, 1);
+            }
+        }
+    }
+
+    void copy_from(const stats_log &other) noexcept {
+        const queue_stats values = other.stats();
+        enqueued.store(values.enqueued, std::memory_order_relaxed);
+        dequeued.store(values.dequeued, std::memory_order_relaxed);
+        overwritten.store(values.overwritten, std::memory_order_relaxed);
+        dropped.store(values.dropped, std::memory_order_relaxed);
+        rejected.store(values.rejected, std::memory_order_relaxed);
+        cleared.store(values.cleared, std::memory_order_relaxed);
+        full_hits.store(values.full_hits, std::memory_order_relaxed);
+        empty_hits.store(values.empty_hits, std::memory_order_relaxed);
+        high_water_mark.store(values.high_water_mark, std::memory_order_relaxed);
+        residency_samples.store(values.residency_samples, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < residency_histogram.size(); ++i) {
+            residency_histogram[i].store(values.residency_histogram[i], std::memory_order_relaxed);
+        }
+        live = other.live;
+        added = other.added;
+        removed = other.removed;
+        next_sample = other.next_sample;
+        samples = other.samples;
+        sample_head = other.sample_head;
+        sample_tail = other.sample_tail;
+    }
+
+};
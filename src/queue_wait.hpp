@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#include "queue_detail.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Number of failed attempts a blocking operation spins through before it parks.
+     */
+    constexpr int spin_limit = 256;
+
+    /**
+     * @brief Tells the processor that the caller is busy-waiting.
+     */
+    inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    /**
+     * @brief An event count that lets threads sleep until a queue changes state.
+     *
+     * A waiter registers itself with prepare_wait, re-checks its condition and
+     * then sleeps in wait until the epoch moves on or the deadline passes. A
+     * notifier bumps the epoch and wakes a sleeper, but only if a waiter is
+     * registered, so notifying an idle event count costs a fence and a load.
+     *
+     * Sleeping uses a futex on Linux and a mutex/condition variable pair
+     * elsewhere. C++20 std::atomic::wait is not used because it has no timeout.
+     */
+    class alignas(cache_line_size) event_count {
+
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be a plain 32-bit integer");
+
+        std::atomic<std::uint32_t> epoch{0};        ///< Incremented by every notification that finds a waiter
+        std::atomic<std::uint32_t> waiters{0};      ///< Number of threads between prepare_wait and the end of wait
+#if !defined(__linux__)
+        std::mutex mutex;                           ///< Protects the epoch check of sleeping waiters
+        std::condition_variable condition;          ///< Wakes sleeping waiters
+#endif
+
+    public:
+
+        /**
+         * @brief Registers the calling thread as a waiter.
+         *
+         * The caller must re-check its condition after this call and then either
+         * call wait with the returned key or call cancel_wait.
+         *
+         * @return The key to pass to wait.
+         */
+        std::uint32_t prepare_wait() {
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return epoch.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Unregisters a waiter whose condition became true after prepare_wait.
+         */
+        void cancel_wait() {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Sleeps until a notification arrives after prepare_wait, or until the deadline.
+         *
+         * May return early without a notification; callers re-check their condition in a loop.
+         *
+         * @param key The value returned by prepare_wait.
+         * @param deadline The point in time after which to stop waiting.
+         * @return False if the deadline has passed, true otherwise.
+         */
+        bool wait(std::uint32_t key, std::chrono::steady_clock::time_point deadline) {
+            bool in_time = true;
+#if defined(__linux__)
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                in_time = false;
+            } else if (epoch.load(std::memory_order_acquire) == key) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+                timespec timeout{};
+                timeout.tv_sec = static_cast<time_t>(remaining / 1000000000);
+                timeout.tv_nsec = static_cast<long>(remaining % 1000000000);
+                syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, key, &timeout,
+                        nullptr, 0);
+            }
+#else
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                in_time = condition.wait_until(lock, deadline, [&] {
+                    return epoch.load(std::memory_order_acquire) != key;
+                });
+            }
+#endif
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return in_time;
+        }
+
+        /**
+         * @brief Wakes one waiter, if any is registered.
+         *
+         * Must be called after the state change the waiters are looking for has been published.
+         */
+        void notify_one() {
+            notify(1);
+        }
+
+        /**
+         * @brief Wakes every registered waiter.
+         *
+         * Must be called after the state change the waiters are looking for has been published.
+         */
+        void notify_all() {
+            notify(INT_MAX);
+        }
+
+    private:
+
+        /**
+         * @brief Bumps the epoch and wakes up to count sleepers if a waiter is registered.
+         *
+         * @param count The maximum number of sleepers to wake.
+         */
+        void notify(int count) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE, count, nullptr,
+                    nullptr, 0);
+#else
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+            }
+            if (count == 1) {
+                condition.notify_one();
+            } else {
+                condition.notify_all();
+            }
+#endif
+        }
+
+    };
+
+    /**
+     * @brief Stand-in for event_count in queues built without blocking support.
+     *
+     * Every member is an empty inline function, so notifications compile away.
+     */
+    struct null_event_count {
+
+        void notify_one() {
+        }
+
+        void notify_all() {
+        }
+
+    };
+
+    /**
+     * @brief Retries an operation, first by spinning and then by parking on an event count.
+     *
+     * The operation is attempted up to spin_limit times with a pause in between.
+     * After that the thread registers with the event count, attempts once more
+     * and sleeps until notified, repeating until the operation succeeds or the
+     * timeout expires.
+     *
+     * @param event The event count notified when the operation may succeed.
+     * @param timeout The maximum time to wait.
+     * @param attempt Callable that performs the operation and returns true on success.
+     * @return True if the operation succeeded, false if the timeout expired.
+     */
+    template<typename Rep, typename Period, typename Attempt>
+    bool spin_then_park(event_count &event, const std::chrono::duration<Rep, Period> &timeout, Attempt attempt) {
+        for (int i = 0; i < spin_limit; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            cpu_relax();
+        }
+
+        using clock = std::chrono::steady_clock;
+        const clock::time_point now = clock::now();
+        clock::time_point deadline = clock::time_point::max();
+        if (std::chrono::duration<double>(timeout) < std::chrono::duration<double>(deadline - now)) {
+            deadline = now + std::chrono::duration_cast<clock::duration>(timeout);
+        }
+
+        for (;;) {
+            const std::uint32_t key = event.prepare_wait();
+            if (attempt()) {
+                event.cancel_wait();
+                return true;
+            }
+            if (!event.wait(key, deadline)) {
+                return attempt();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__has_include) && __cplusplus > 201703L
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+
+/**
+ * @brief A random-access iterator over the live elements of a power-of-two ring.
+ *
+ * The iterator holds the storage pointer, the index mask and a free-running
+ * position, so advancing it or indexing from it is an addition and a mask;
+ * it never branches on the wrap point. Two iterators into the same queue
+ * compare by position, which makes end() - begin() the number of elements.
+ *
+ * Iterators stay valid while elements are only added at the rear without
+ * overwriting, and are invalidated by anything that removes the element they
+ * refer to or replaces the storage (resize, move).
+ *
+ * @tparam T The element type; const-qualified for const_iterator.
+ */
+template<typename T>
+class ring_iterator {
+
+    template<typename U>
+    friend class ring_iterator;
+
+    T *base{};                  ///< Start of the ring storage
+    std::size_t mask{};         ///< Index mask of the ring storage
+    std::size_t pos{};          ///< Free-running position of the element
+
+public:
+
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const<T>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    ring_iterator() = default;
+
+    /**
+     * @brief Constructor that places the iterator at a position of a ring.
+     *
+     * @param base Start of the ring storage.
+     * @param mask Index mask of the ring storage.
+     * @param pos Free-running position of the element; only its low bits select the slot.
+     */
+    ring_iterator(T *base, std::size_t mask, std::size_t pos) noexcept
+        : base(base), mask(mask), pos(pos) {
+    }
+
+    /**
+     * @brief Converts an iterator over mutable elements into a const_iterator.
+     */
+    template<typename U, typename = typename std::enable_if<
+        std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+    ring_iterator(const ring_iterator<U> &other) noexcept
+        : base(other.base), mask(other.mask), pos(other.pos) {
+    }
+
+    reference operator*() const noexcept {
+        return base[pos & mask];
+    }
+
+    pointer operator->() const noexcept {
+        return base + (pos & mask);
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return base[(pos + static_cast<std::size_t>(n)) & mask];
+    }
+
+    ring_iterator &operator++() noexcept {
+        ++pos;
+        return *this;
+    }
+
+    ring_iterator operator++(int) noexcept {
+        ring_iterator copy = *this;
+        ++pos;
+        return copy;
+    }
+
+    ring_iterator &operator--() noexcept {
+        --pos;
+        return *this;
+    }
+
+    ring_iterator operator--(int) noexcept {
+        ring_iterator copy = *this;
+        --pos;
+        return copy;
+    }
+
+    ring_iterator &operator+=(difference_type n) noexcept {
+        pos += static_cast<std::size_t>(n);
+        return *this;
+    }
+
+    ring_iterator &operator-=(difference_type n) noexcept {
+        pos -= static_cast<std::size_t>(n);
+        return *this;
+    }
+
+    friend ring_iterator operator+(ring_iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend ring_iterator operator+(difference_type n, ring_iterator it) noexcept {
+        return it += n;
+    }
+
+    friend ring_iterator operator-(ring_iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.pos - rhs.pos);
+    }
+
+    friend bool operator==(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return lhs.pos == rhs.pos;
+    }
+
+    friend bool operator!=(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return lhs.pos != rhs.pos;
+    }
+
+    friend bool operator<(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return lhs - rhs < 0;
+    }
+
+    friend bool operator>(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend bool operator<=(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>=(const ring_iterator &lhs, const ring_iterator &rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+};
+
+#if defined(__cpp_lib_ranges)
+static_assert(std::random_access_iterator<ring_iterator<int>>);
+static_assert(std::random_access_iterator<ring_iterator<const int>>);
+#endif
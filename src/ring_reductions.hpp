@@ -0,0 +1,722 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "circular_queue.hpp"
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Lane operations used by the reduction kernels; this primary template is the scalar fallback.
+     *
+     * Specializations below map the same operations onto AVX-512, AVX/AVX2 or
+     * NEON registers when the translation unit is compiled for them (for
+     * example with -mavx2 or -march=native). Every kernel is written once
+     * against this interface, so the scalar build is simply the one-lane case
+     * and still gets the four independent accumulators of the vector builds.
+     *
+     * @tparam T The element type.
+     */
+    template<typename T>
+    struct simd_ops {
+        using vec = T;
+        static constexpr std::size_t lanes = 1;
+
+        static vec load(const T *p) { return *p; }
+        static void store(T *p, vec v) { *p = v; }
+        static vec add(vec a, vec b) { return a + b; }
+        static vec mul_add(vec acc, vec a, vec b) { return acc + a * b; }
+        static vec min(vec a, vec b) { return b < a ? b : a; }
+        static vec max(vec a, vec b) { return a < b ? b : a; }
+    };
+
+#if defined(__AVX512F__)
+    // min and max use the all-lanes masked forms: the unmasked intrinsics pass an
+    // undefined source vector that GCC 12 reports under -Wmaybe-uninitialized
+    template<>
+    struct simd_ops<float> {
+        using vec = __m512;
+        static constexpr std::size_t lanes = 16;
+
+        static vec load(const float *p) { return _mm512_loadu_ps(p); }
+        static void store(float *p, vec v) { _mm512_storeu_ps(p, v); }
+        static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return _mm512_fmadd_ps(a, b, acc); }
+        static vec min(vec a, vec b) { return _mm512_mask_min_ps(a, 0xFFFF, a, b); }
+        static vec max(vec a, vec b) { return _mm512_mask_max_ps(a, 0xFFFF, a, b); }
+    };
+
+    template<>
+    struct simd_ops<double> {
+        using vec = __m512d;
+        static constexpr std::size_t lanes = 8;
+
+        static vec load(const double *p) { return _mm512_loadu_pd(p); }
+        static void store(double *p, vec v) { _mm512_storeu_pd(p, v); }
+        static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return _mm512_fmadd_pd(a, b, acc); }
+        static vec min(vec a, vec b) { return _mm512_mask_min_pd(a, 0xFF, a, b); }
+        static vec max(vec a, vec b) { return _mm512_mask_max_pd(a, 0xFF, a, b); }
+    };
+
+    template<>
+    struct simd_ops<std::int32_t> {
+        using vec = __m512i;
+        static constexpr std::size_t lanes = 16;
+
+        static vec load(const std::int32_t *p) { return _mm512_loadu_si512(p); }
+        static void store(std::int32_t *p, vec v) { _mm512_storeu_si512(p, v); }
+        static vec add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return _mm512_add_epi32(acc, _mm512_mullo_epi32(a, b)); }
+        static vec min(vec a, vec b) { return _mm512_mask_min_epi32(a, 0xFFFF, a, b); }
+        static vec max(vec a, vec b) { return _mm512_mask_max_epi32(a, 0xFFFF, a, b); }
+    };
+
+    template<>
+    struct simd_ops<std::int64_t> {
+        using vec = __m512i;
+        static constexpr std::size_t lanes = 8;
+
+        static vec load(const std::int64_t *p) { return _mm512_loadu_si512(p); }
+        static void store(std::int64_t *p, vec v) { _mm512_storeu_si512(p, v); }
+        static vec add(vec a, vec b) { return _mm512_add_epi64(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) {
+#if defined(__AVX512DQ__)
+            return _mm512_add_epi64(acc, _mm512_mullo_epi64(a, b));
+#else
+            alignas(64) std::int64_t x[lanes], y[lanes];
+            store(x, a);
+            store(y, b);
+            for (std::size_t i = 0; i < lanes; ++i) {
+                x[i] *= y[i];
+            }
+            return _mm512_add_epi64(acc, load(x));
+#endif
+        }
+        static vec min(vec a, vec b) { return _mm512_mask_min_epi64(a, 0xFF, a, b); }
+        static vec max(vec a, vec b) { return _mm512_mask_max_epi64(a, 0xFF, a, b); }
+    };
+#elif defined(__AVX__)
+    template<>
+    struct simd_ops<float> {
+        using vec = __m256;
+        static constexpr std::size_t lanes = 8;
+
+        static vec load(const float *p) { return _mm256_loadu_ps(p); }
+        static void store(float *p, vec v) { _mm256_storeu_ps(p, v); }
+        static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+#if defined(__FMA__)
+        static vec mul_add(vec acc, vec a, vec b) { return _mm256_fmadd_ps(a, b, acc); }
+#else
+        static vec mul_add(vec acc, vec a, vec b) { return _mm256_add_ps(acc, _mm256_mul_ps(a, b)); }
+#endif
+        static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+    };
+
+    template<>
+    struct simd_ops<double> {
+        using vec = __m256d;
+        static constexpr std::size_t lanes = 4;
+
+        static vec load(const double *p) { return _mm256_loadu_pd(p); }
+        static void store(double *p, vec v) { _mm256_storeu_pd(p, v); }
+        static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+#if defined(__FMA__)
+        static vec mul_add(vec acc, vec a, vec b) { return _mm256_fmadd_pd(a, b, acc); }
+#else
+        static vec mul_add(vec acc, vec a, vec b) { return _mm256_add_pd(acc, _mm256_mul_pd(a, b)); }
+#endif
+        static vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+    };
+
+#if defined(__AVX2__)
+    template<>
+    struct simd_ops<std::int32_t> {
+        using vec = __m256i;
+        static constexpr std::size_t lanes = 8;
+
+        static vec load(const std::int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(std::int32_t *p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return _mm256_add_epi32(acc, _mm256_mullo_epi32(a, b)); }
+        static vec min(vec a, vec b) { return _mm256_min_epi32(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+    };
+
+    template<>
+    struct simd_ops<std::int64_t> {
+        using vec = __m256i;
+        static constexpr std::size_t lanes = 4;
+
+        static vec load(const std::int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(std::int64_t *p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        static vec add(vec a, vec b) { return _mm256_add_epi64(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) {
+            // AVX2 has no 64-bit multiply; the products are formed lane by lane
+            alignas(32) std::int64_t x[lanes], y[lanes];
+            store(x, a);
+            store(y, b);
+            for (std::size_t i = 0; i < lanes; ++i) {
+                x[i] *= y[i];
+            }
+            return _mm256_add_epi64(acc, load(x));
+        }
+        static vec min(vec a, vec b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+        static vec max(vec a, vec b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+    };
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    template<>
+    struct simd_ops<float> {
+        using vec = float32x4_t;
+        static constexpr std::size_t lanes = 4;
+
+        static vec load(const float *p) { return vld1q_f32(p); }
+        static void store(float *p, vec v) { vst1q_f32(p, v); }
+        static vec add(vec a, vec b) { return vaddq_f32(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return vfmaq_f32(acc, a, b); }
+        static vec min(vec a, vec b) { return vminq_f32(a, b); }
+        static vec max(vec a, vec b) { return vmaxq_f32(a, b); }
+    };
+
+    template<>
+    struct simd_ops<double> {
+        using vec = float64x2_t;
+        static constexpr std::size_t lanes = 2;
+
+        static vec load(const double *p) { return vld1q_f64(p); }
+        static void store(double *p, vec v) { vst1q_f64(p, v); }
+        static vec add(vec a, vec b) { return vaddq_f64(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return vfmaq_f64(acc, a, b); }
+        static vec min(vec a, vec b) { return vminq_f64(a, b); }
+        static vec max(vec a, vec b) { return vmaxq_f64(a, b); }
+    };
+
+    template<>
+    struct simd_ops<std::int32_t> {
+        using vec = int32x4_t;
+        static constexpr std::size_t lanes = 4;
+
+        static vec load(const std::int32_t *p) { return vld1q_s32(p); }
+        static void store(std::int32_t *p, vec v) { vst1q_s32(p, v); }
+        static vec add(vec a, vec b) { return vaddq_s32(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) { return vmlaq_s32(acc, a, b); }
+        static vec min(vec a, vec b) { return vminq_s32(a, b); }
+        static vec max(vec a, vec b) { return vmaxq_s32(a, b); }
+    };
+
+    template<>
+    struct simd_ops<std::int64_t> {
+        using vec = int64x2_t;
+        static constexpr std::size_t lanes = 2;
+
+        static vec load(const std::int64_t *p) { return vld1q_s64(p); }
+        static void store(std::int64_t *p, vec v) { vst1q_s64(p, v); }
+        static vec add(vec a, vec b) { return vaddq_s64(a, b); }
+        static vec mul_add(vec acc, vec a, vec b) {
+            // NEON has no 64-bit multiply; the products are formed lane by lane
+            return vaddq_s64(acc, vcombine_s64(vdup_n_s64(vgetq_lane_s64(a, 0) * vgetq_lane_s64(b, 0)),
+                                               vdup_n_s64(vgetq_lane_s64(a, 1) * vgetq_lane_s64(b, 1))));
+        }
+        static vec min(vec a, vec b) { return vbslq_s64(vcgtq_s64(a, b), b, a); }
+        static vec max(vec a, vec b) { return vbslq_s64(vcgtq_s64(a, b), a, b); }
+    };
+#endif
+
+    /**
+     * @brief Combines the lanes of a vector into one value.
+     *
+     * Called once per kernel invocation, so a round trip through memory is cheaper
+     * than a per-ISA shuffle sequence.
+     */
+    template<typename T, typename Combine>
+    T fold_lanes(typename simd_ops<T>::vec v, Combine combine) {
+        T lanes[simd_ops<T>::lanes];
+        simd_ops<T>::store(lanes, v);
+        T result = lanes[0];
+        for (std::size_t i = 1; i < simd_ops<T>::lanes; ++i) {
+            result = combine(result, lanes[i]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sums a contiguous run with four independent vector accumulators.
+     */
+    template<typename T>
+    T sum_run(const T *p, std::size_t n) {
+        using ops = simd_ops<T>;
+        constexpr std::size_t step = ops::lanes * 4;
+        std::size_t i = 0;
+        T total = T();
+        if (n >= step) {
+            typename ops::vec a0 = ops::load(p), a1 = ops::load(p + ops::lanes);
+            typename ops::vec a2 = ops::load(p + 2 * ops::lanes), a3 = ops::load(p + 3 * ops::lanes);
+            for (i = step; i + step <= n; i += step) {
+                a0 = ops::add(a0, ops::load(p + i));
+                a1 = ops::add(a1, ops::load(p + i + ops::lanes));
+                a2 = ops::add(a2, ops::load(p + i + 2 * ops::lanes));
+                a3 = ops::add(a3, ops::load(p + i + 3 * ops::lanes));
+            }
+            total = fold_lanes<T>(ops::add(ops::add(a0, a1), ops::add(a2, a3)), [](T a, T b) { return a + b; });
+        }
+        for (; i < n; ++i) {
+            total += p[i];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Computes the dot product of two contiguous runs with four independent vector accumulators.
+     */
+    template<typename T>
+    T dot_run(const T *a, const T *b, std::size_t n) {
+        using ops = simd_ops<T>;
+        constexpr std::size_t step = ops::lanes * 4;
+        std::size_t i = 0;
+        T total = T();
+        if (n >= step) {
+            typename ops::vec zero;
+            const T zeros[ops::lanes] = {};
+            zero = ops::load(zeros);
+            typename ops::vec a0 = zero, a1 = zero, a2 = zero, a3 = zero;
+            for (; i + step <= n; i += step) {
+                a0 = ops::mul_add(a0, ops::load(a + i), ops::load(b + i));
+                a1 = ops::mul_add(a1, ops::load(a + i + ops::lanes), ops::load(b + i + ops::lanes));
+                a2 = ops::mul_add(a2, ops::load(a + i + 2 * ops::lanes), ops::load(b + i + 2 * ops::lanes));
+                a3 = ops::mul_add(a3, ops::load(a + i + 3 * ops::lanes), ops::load(b + i + 3 * ops::lanes));
+            }
+            total = fold_lanes<T>(ops::add(ops::add(a0, a1), ops::add(a2, a3)), [](T x, T y) { return x + y; });
+        }
+        for (; i < n; ++i) {
+            total += a[i] * b[i];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Folds a contiguous run into init with the lane-wise min or max.
+     *
+     * @tparam Max True for the maximum, false for the minimum.
+     */
+    template<bool Max, typename T>
+    T extreme_run(const T *p, std::size_t n, T init) {
+        using ops = simd_ops<T>;
+        constexpr std::size_t step = ops::lanes * 4;
+        const auto pick = [](T a, T b) { return Max ? (a < b ? b : a) : (b < a ? b : a); };
+        const auto pick_vec = [](typename ops::vec a, typename ops::vec b) {
+            return Max ? ops::max(a, b) : ops::min(a, b);
+        };
+        std::size_t i = 0;
+        if (n >= step) {
+            typename ops::vec a0 = ops::load(p), a1 = ops::load(p + ops::lanes);
+            typename ops::vec a2 = ops::load(p + 2 * ops::lanes), a3 = ops::load(p + 3 * ops::lanes);
+            for (i = step; i + step <= n; i += step) {
+                a0 = pick_vec(a0, ops::load(p + i));
+                a1 = pick_vec(a1, ops::load(p + i + ops::lanes));
+                a2 = pick_vec(a2, ops::load(p + i + 2 * ops::lanes));
+                a3 = pick_vec(a3, ops::load(p + i + 3 * ops::lanes));
+            }
+            init = pick(init, fold_lanes<T>(pick_vec(pick_vec(a0, a1), pick_vec(a2, a3)), pick));
+        }
+        for (; i < n; ++i) {
+            init = pick(init, p[i]);
+        }
+        return init;
+    }
+
+    /**
+     * @brief Returns the first element of a window; throws if the window is empty.
+     */
+    template<typename T>
+    const T &first_of(const ring_span_pair<const T> &window) {
+        if (window.first.empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return window.first[0];
+    }
+
+}
+
+/**
+ * @brief Sums the elements of a ring window given as its two contiguous runs.
+ *
+ * Integer sums wrap like T. Floating-point sums are accumulated in several
+ * lanes, so the rounding can differ from a strictly sequential sum.
+ *
+ * @param window The runs returned by read_peek.
+ * @return The sum of the elements, or T() for an empty window.
+ */
+template<typename T>
+T window_sum(const ring_span_pair<const T> &window) {
+    return cqueue_detail::sum_run(window.first.data(), window.first.size()) +
+           cqueue_detail::sum_run(window.second.data(), window.second.size());
+}
+
+/**
+ * @brief Returns the smallest element of a ring window given as its two contiguous runs.
+ *
+ * @param window The runs returned by read_peek.
+ * @return The smallest element.
+ * @throws std::underflow_error if the window is empty.
+ */
+template<typename T>
+T window_min(const ring_span_pair<const T> &window) {
+    const T first = cqueue_detail::first_of(window);
+    const T partial = cqueue_detail::extreme_run<false>(window.first.data(), window.first.size(), first);
+    return cqueue_detail::extreme_run<false>(window.second.data(), window.second.size(), partial);
+}
+
+/**
+ * @brief Returns the largest element of a ring window given as its two contiguous runs.
+ *
+ * @param window The runs returned by read_peek.
+ * @return The largest element.
+ * @throws std::underflow_error if the window is empty.
+ */
+template<typename T>
+T window_max(const ring_span_pair<const T> &window) {
+    const T first = cqueue_detail::first_of(window);
+    const T partial = cqueue_detail::extreme_run<true>(window.first.data(), window.first.size(), first);
+    return cqueue_detail::extreme_run<true>(window.second.data(), window.second.size(), partial);
+}
+
+/**
+ * @brief Computes the dot product of a ring window with a contiguous array of weights.
+ *
+ * The first weight applies to the front (oldest) element.
+ *
+ * @param window The runs returned by read_peek.
+ * @param weights Pointer to at least as many weights as the window has elements.
+ * @return The weighted sum.
+ */
+template<typename T>
+T window_dot(const ring_span_pair<const T> &window, const T *weights) {
+    return cqueue_detail::dot_run(window.first.data(), weights, window.first.size()) +
+           cqueue_detail::dot_run(window.second.data(), weights + window.first.size(), window.second.size());
+}
+
+/**
+ * @brief Counts the elements of a ring window that satisfy a predicate.
+ *
+ * @param window The runs returned by read_peek.
+ * @param pred Callable taking a const T& and returning bool.
+ * @return The number of matching elements.
+ */
+template<typename T, typename Predicate>
+std::size_t window_count_if(const ring_span_pair<const T> &window, Predicate pred) {
+    std::size_t count = 0;
+    for (const T &value : window.first) {
+        count += pred(value) ? 1 : 0;
+    }
+    for (const T &value : window.second) {
+        count += pred(value) ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * @brief Sums every element of a queue in place (see the ring_span_pair overload).
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator>
+T window_sum(const circular_queue<T, Logger, Overflow, Allocator> &queue) {
+    return window_sum(queue.read_peek(queue.get_size()));
+}
+
+/**
+ * @brief Returns the smallest element of a queue (see the ring_span_pair overload).
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator>
+T window_min(const circular_queue<T, Logger, Overflow, Allocator> &queue) {
+    return window_min(queue.read_peek(queue.get_size()));
+}
+
+/**
+ * @brief Returns the largest element of a queue (see the ring_span_pair overload).
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator>
+T window_max(const circular_queue<T, Logger, Overflow, Allocator> &queue) {
+    return window_max(queue.read_peek(queue.get_size()));
+}
+
+/**
+ * @brief Returns the arithmetic mean of the elements of a queue.
+ *
+ * @param queue The queue to average.
+ * @return The mean as a double.
+ * @throws std::underflow_error if the queue is empty.
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator>
+double window_mean(const circular_queue<T, Logger, Overflow, Allocator> &queue) {
+    if (queue.is_empty()) {
+        CQUEUE_THROW(std::underflow_error("Queue is empty"));
+    }
+    return static_cast<double>(window_sum(queue)) / static_cast<double>(queue.get_size());
+}
+
+/**
+ * @brief Computes the dot product of a queue with an array of weights (see the ring_span_pair overload).
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator>
+T window_dot(const circular_queue<T, Logger, Overflow, Allocator> &queue, const T *weights) {
+    return window_dot(queue.read_peek(queue.get_size()), weights);
+}
+
+/**
+ * @brief Counts the elements of a queue that satisfy a predicate (see the ring_span_pair overload).
+ */
+template<typename T, typename Logger, typename Overflow, typename Allocator, typename Predicate>
+std::size_t window_count_if(const circular_queue<T, Logger, Overflow, Allocator> &queue, Predicate pred) {
+    return window_count_if(queue.read_peek(queue.get_size()), pred);
+}
+
+/**
+ * @brief A fixed-size sliding window that keeps its sum, minimum and maximum up to date on every push.
+ *
+ * The values live in a circular_queue that overwrites its oldest element.
+ * Alongside it the window keeps a running sum and two monotonic queues of
+ * candidates for the minimum and maximum, so push is amortized O(1) and
+ * sum, mean, min and max are O(1) reads instead of a pass over the window.
+ *
+ * For floating-point T the running sum picks up rounding error with every
+ * add and subtract; recompute_sum replaces it with an exact pass over the
+ * window (vectorized with window_sum) and can be called periodically.
+ *
+ * @tparam T An arithmetic element type.
+ */
+template<typename T>
+class sliding_window {
+
+    static_assert(std::is_arithmetic<T>::value, "sliding_window requires an arithmetic type");
+
+    /**
+     * @brief A value that may still become the minimum or maximum, tagged with its position.
+     */
+    struct candidate {
+        std::uint64_t pos;      ///< Position of the value in the stream of pushes
+        T value;                ///< The value
+    };
+
+    /**
+     * @brief A monotonic double-ended queue of candidates in a fixed power-of-two ring.
+     */
+    struct monotonic_ring {
+        std::vector<candidate> slots;   ///< Ring storage, one slot per window element
+        std::size_t mask{};             ///< Index mask of the ring
+        std::uint64_t head{}, tail{};   ///< Free-running counters of the live candidates
+
+        explicit monotonic_ring(std::size_t n)
+            : slots(cqueue_detail::next_power_of_two(n)), mask(slots.size() - 1) {
+        }
+
+        /**
+         * @brief Appends a value after dropping every candidate it dominates.
+         *
+         * @tparam Max True to keep a decreasing queue (maximum), false for an increasing one (minimum).
+         */
+        template<bool Max>
+        void push(std::uint64_t pos, T value) {
+            while (head != tail) {
+                const T back = slots[static_cast<std::size_t>((tail - 1) & mask)].value;
+                if (Max ? back > value : back < value) {
+                    break;
+                }
+                --tail;
+            }
+            slots[static_cast<std::size_t>(tail & mask)] = candidate{pos, value};
+            ++tail;
+        }
+
+        /**
+         * @brief Drops the front candidates that have left the window.
+         *
+         * @param oldest The position of the oldest value still in the window.
+         */
+        void expire(std::uint64_t oldest) {
+            while (head != tail && slots[static_cast<std::size_t>(head & mask)].pos < oldest) {
+                ++head;
+            }
+        }
+
+        const T &front() const {
+            return slots[static_cast<std::size_t>(head & mask)].value;
+        }
+
+        void clear() {
+            head = tail = 0;
+        }
+    };
+
+    circular_queue<T> values;           ///< The values in the window, oldest first
+    T running_sum{};                    ///< Sum of the values in the window
+    monotonic_ring minima;              ///< Candidates for the minimum, increasing
+    monotonic_ring maxima;              ///< Candidates for the maximum, decreasing
+    std::uint64_t pushed{};             ///< Number of values pushed so far
+
+public:
+
+    /**
+     * @brief Constructor that creates an empty window.
+     *
+     * @param n The number of most recent values the window covers.
+     * @throws std::invalid_argument if n is 0.
+     */
+    explicit sliding_window(std::size_t n)
+        : values(n), minima(n), maxima(n) {
+    }
+
+    /**
+     * @brief Adds a value, evicting the oldest one once the window is full.
+     *
+     * @param value The value to add.
+     */
+    void push(T value) {
+        if (values.is_full()) {
+            running_sum -= values.peek();
+        }
+        values.enqueue(value);
+        running_sum += value;
+
+        // Expire first: a full window plus the new candidate would not fit a ring of n slots
+        const std::uint64_t oldest = pushed + 1 - values.get_size();
+        minima.expire(oldest);
+        maxima.expire(oldest);
+        minima.template push<false>(pushed, value);
+        maxima.template push<true>(pushed, value);
+        ++pushed;
+    }
+
+    /**
+     * @brief Removes the k oldest values before the window would have pushed them out.
+     *
+     * The evicted values are subtracted from the running sum with one
+     * window_sum pass, and the minimum and maximum candidates among them are
+     * dropped, so evicting is O(k) with vector throughput rather than a
+     * rebuild of the window.
+     *
+     * @param k The number of values to remove.
+     * @throws std::invalid_argument if k exceeds the current size.
+     */
+    void evict(std::size_t k) {
+        if (k > values.get_size()) {
+            CQUEUE_THROW(std::invalid_argument("Cannot evict more values than the window holds"));
+        }
+        if (k == 0) {
+            return;
+        }
+        const circular_queue<T> &window = values;
+        running_sum -= window_sum(window.read_peek(k));
+        values.read_release(k);
+        const std::uint64_t oldest = pushed - values.get_size();
+        minima.expire(oldest);
+        maxima.expire(oldest);
+    }
+
+    /**
+     * @brief Returns the sum of the values in the window.
+     *
+     * @return The running sum, or T() for an empty window.
+     */
+    T sum() const {
+        return running_sum;
+    }
+
+    /**
+     * @brief Returns the arithmetic mean of the values in the window.
+     *
+     * @return The mean as a double.
+     * @throws std::underflow_error if the window is empty.
+     */
+    double mean() const {
+        if (values.is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return static_cast<double>(running_sum) / static_cast<double>(values.get_size());
+    }
+
+    /**
+     * @brief Returns the smallest value in the window.
+     *
+     * @return The minimum.
+     * @throws std::underflow_error if the window is empty.
+     */
+    T min() const {
+        if (values.is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return minima.front();
+    }
+
+    /**
+     * @brief Returns the largest value in the window.
+     *
+     * @return The maximum.
+     * @throws std::underflow_error if the window is empty.
+     */
+    T max() const {
+        if (values.is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return maxima.front();
+    }
+
+    /**
+     * @brief Recomputes the running sum from the values in the window.
+     */
+    void recompute_sum() {
+        running_sum = window_sum(values);
+    }
+
+    /**
+     * @brief Removes every value from the window.
+     */
+    void clear() {
+        values.clear();
+        running_sum = T();
+        minima.clear();
+        maxima.clear();
+    }
+
+    /**
+     * @brief Returns the values in the window, oldest first.
+     *
+     * @return The underlying queue.
+     */
+    const circular_queue<T> &get_values() const {
+        return values;
+    }
+
+    /**
+     * @brief Returns the number of values in the window.
+     *
+     * @return The current size of the window.
+     */
+    std::size_t get_size() const {
+        return values.get_size();
+    }
+
+    /**
+     * @brief Returns the number of values the window covers when full.
+     *
+     * @return The capacity of the window.
+     */
+    std::size_t get_capacity() const {
+        return values.get_capacity();
+    }
+
+};
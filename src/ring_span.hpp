@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A non-owning view of a contiguous run of elements inside a ring buffer.
+ *
+ * The reservation and peek APIs of the queues hand out their storage as at
+ * most two of these spans: one up to the end of the storage and one starting
+ * again at its beginning after the wrap point. The second span is empty when
+ * the range does not wrap.
+ *
+ * @tparam T The element type; const-qualified for read-only views.
+ */
+template<typename T>
+class ring_span {
+
+    T *ptr{};                   ///< Pointer to the first element of the run
+    std::size_t count{};        ///< Number of elements in the run
+
+public:
+
+    ring_span() = default;
+
+    /**
+     * @brief Constructor that creates a view of count elements starting at ptr.
+     *
+     * @param ptr Pointer to the first element.
+     * @param count The number of elements in the view.
+     */
+    ring_span(T *ptr, std::size_t count)
+        : ptr(ptr), count(count) {
+    }
+
+    /**
+     * @brief Converts a view of mutable elements into a read-only view.
+     */
+    template<typename U, typename = typename std::enable_if<
+        std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+    ring_span(const ring_span<U> &other)
+        : ptr(other.data()), count(other.size()) {
+    }
+
+    T *data() const {
+        return ptr;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    T *begin() const {
+        return ptr;
+    }
+
+    T *end() const {
+        return ptr + count;
+    }
+
+    T &operator[](std::size_t index) const {
+        return ptr[index];
+    }
+
+};
+
+/**
+ * @brief The (up to) two contiguous runs that make up a range of ring storage, in order.
+ */
+template<typename T>
+using ring_span_pair = std::pair<ring_span<T>, ring_span<T>>;
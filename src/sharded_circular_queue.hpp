@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "mpmc_circular_queue.hpp"
+#include "queue_detail.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Returns the calling thread's slot, which picks its local shard.
+     *
+     * Threads are numbered round-robin the first time they ask, so a pool of N
+     * workers on N shards spreads one worker per shard; bind_thread_slot
+     * replaces the number, for example with a core or NUMA node index.
+     */
+    inline std::size_t &thread_slot() noexcept {
+        static std::atomic<std::size_t> next_slot{0};
+        thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+}
+
+/**
+ * @brief A set of MPMC rings, one per core or NUMA node, presented as one queue.
+ *
+ * A single mpmc_circular_queue serializes every producer on its enqueue index
+ * and every consumer on its dequeue index, so adding cores eventually adds
+ * only cache-line traffic. Here each thread has a local shard, chosen from
+ * its thread slot, and works on it first: producers enqueue to it and
+ * consumers drain it before stealing from the other shards in turn. While
+ * the load is balanced, threads on different shards touch disjoint cache lines.
+ *
+ * Order is FIFO within each shard only. Elements added to different shards,
+ * by different threads or after a spill, may come out in any order relative to
+ * each other, which is the relaxation that lets throughput scale. An enqueue
+ * that finds its local shard full spills to the next shard that has room, so
+ * it fails only when every shard is full.
+ *
+ * Like mpmc_circular_queue, every operation may be called from any number of
+ * threads concurrently, and the constructor of T used by an enqueue must not
+ * throw.
+ *
+ * @tparam T The type of elements in the queue.
+ */
+template<typename T>
+class sharded_circular_queue {
+
+    using shard_type = mpmc_circular_queue<T>;
+
+    // One block for all shards; placement new keeps their cache-line alignment without C++17 aligned new
+    std::unique_ptr<unsigned char[]> storage;      ///< Raw memory holding the shards
+    shard_type *shards{};                           ///< The first shard, aligned within storage
+    std::size_t count{};                            ///< Number of shards
+
+public:
+
+    /**
+     * @brief Constructor that creates empty shards.
+     *
+     * @param shard_capacity The minimum number of elements each shard must hold; rounded up to a power of two.
+     * @param shard_count The number of shards; 0 (the default) uses one per hardware thread.
+     * @throws std::invalid_argument if the given shard capacity is 0.
+     */
+    explicit sharded_circular_queue(std::size_t shard_capacity, std::size_t shard_count = 0) {
+        if (shard_capacity == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        if (shard_count == 0) {
+            shard_count = std::thread::hardware_concurrency();
+            if (shard_count == 0) {
+                shard_count = 1;
+            }
+        }
+        if (shard_count > (static_cast<std::size_t>(-1) - alignof(shard_type)) / sizeof(shard_type)) {
+            CQUEUE_THROW(std::length_error("Too many shards."));
+        }
+        std::size_t space = shard_count * sizeof(shard_type) + alignof(shard_type);
+        storage.reset(new unsigned char[space]);
+        void *first = storage.get();
+        shards = static_cast<shard_type *>(std::align(alignof(shard_type), shard_count * sizeof(shard_type),
+                                                      first, space));
+        CQUEUE_TRY {
+            for (; count < shard_count; ++count) {
+                ::new(static_cast<void *>(shards + count)) shard_type(shard_capacity);
+            }
+        } CQUEUE_CATCH_ALL {
+            destroy_shards();
+            CQUEUE_RETHROW;
+        }
+    }
+
+    sharded_circular_queue(const sharded_circular_queue &) = delete;
+    sharded_circular_queue &operator=(const sharded_circular_queue &) = delete;
+
+    /**
+     * @brief Destroys the remaining elements and releases the shards.
+     *
+     * Must not run concurrently with any producer or consumer.
+     */
+    ~sharded_circular_queue() {
+        destroy_shards();
+    }
+
+    /**
+     * @brief Sets the calling thread's slot; its local shard is the slot modulo the shard count.
+     *
+     * Applies to every sharded_circular_queue the thread uses. Call it once per
+     * worker, for example with the core or NUMA node the worker is pinned to.
+     *
+     * @param slot The new slot of the calling thread.
+     */
+    static void bind_thread_slot(std::size_t slot) noexcept {
+        cqueue_detail::thread_slot() = slot;
+    }
+
+    /**
+     * @brief Returns the calling thread's local shard.
+     *
+     * @return The index of the shard the calling thread enqueues to and drains first.
+     */
+    std::size_t get_local_shard() const noexcept {
+        return cqueue_detail::thread_slot() % count;
+    }
+
+    /**
+     * @brief Adds an element to the local shard, or to the next shard with room.
+     *
+     * @param value The element to be added to the queue.
+     * @return True if the element was added, false if every shard is full.
+     */
+    bool try_enqueue(const T &value) {
+        return try_emplace(value);
+    }
+
+    /**
+     * @brief Moves an element into the local shard, or into the next shard with room.
+     *
+     * @param value The element to be moved into the queue; left untouched if every shard is full.
+     * @return True if the element was added, false if every shard is full.
+     */
+    bool try_enqueue(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place in the local shard, or in the next shard with room.
+     *
+     * @param args Arguments forwarded to the constructor of T; only consumed if the call succeeds.
+     * @return True if the element was added, false if every shard is full.
+     */
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        const std::size_t local = get_local_shard();
+        for (std::size_t i = 0; i < count; ++i) {
+            // A failed try_emplace constructs nothing, so the arguments are still intact for the next shard
+            if (shard_at(local + i).try_emplace(std::forward<Args>(args)...)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Removes an element from the local shard, or steals one from another shard.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if every shard was found empty.
+     */
+    bool try_dequeue(T &out) {
+        const std::size_t local = get_local_shard();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (shard_at(local + i).try_dequeue(out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Removes up to max elements, draining the local shard first and then stealing from the others.
+     *
+     * Each shard is claimed with one bulk operation, so a thief takes a whole
+     * batch from a victim for the price of one contended index update.
+     *
+     * @param out Pointer to the first of at least max elements that receive the removed values.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t try_dequeue_bulk(T *out, std::size_t max) {
+        const std::size_t local = get_local_shard();
+        std::size_t removed = 0;
+        for (std::size_t i = 0; i < count && removed < max; ++i) {
+            removed += shard_at(local + i).try_dequeue_bulk(out + removed, max - removed);
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Checks if every shard is empty.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!shards[i].is_empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in all shards together.
+     *
+     * @return The current size of the queue, as a snapshot.
+     */
+    std::size_t get_size() const {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            size += shards[i].get_size();
+        }
+        return size;
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in one shard.
+     *
+     * @param shard The shard to check; must be less than get_shard_count().
+     * @return The current size of the shard, as a snapshot.
+     */
+    std::size_t get_size(std::size_t shard) const {
+        return shards[shard].get_size();
+    }
+
+    /**
+     * @brief Returns the capacity of all shards together.
+     *
+     * @return The number of elements the queue can hold.
+     */
+    std::size_t get_capacity() const {
+        return count * shards[0].get_capacity();
+    }
+
+    /**
+     * @brief Returns the number of shards.
+     *
+     * @return The shard count chosen at construction.
+     */
+    std::size_t get_shard_count() const {
+        return count;
+    }
+
+private:
+
+    /**
+     * @brief Returns a shard by an index that may exceed the shard count by less than one lap.
+     */
+    shard_type &shard_at(std::size_t i) {
+        return shards[i < count ? i : i - count];
+    }
+
+    void destroy_shards() {
+        for (; count > 0; --count) {
+            shards[count - 1].~shard_type();
+        }
+    }
+
+};
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#if defined(_WIN32)
+#error "shm_circular_queue requires POSIX shared memory"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "queue_detail.hpp"
+
+namespace cqueue_detail {
+
+    /**
+     * @brief Line size used by the shared-memory layout, independent of CQUEUE_CACHE_LINE_SIZE.
+     *
+     * Processes built with different settings must agree on the offsets, so the
+     * layout always pads to 128 bytes, which separates lines on every target.
+     */
+    constexpr std::size_t shm_line_size = 128;
+
+    constexpr std::uint64_t shm_magic = 0x4555455551534843ULL;   ///< "CHSQUEUE" in little-endian
+    constexpr std::uint32_t shm_version = 1;
+    constexpr std::uint32_t shm_initializing = 0;               ///< Creator is still laying out the segment
+    constexpr std::uint32_t shm_ready = 1;                      ///< Segment may be attached to
+
+    /**
+     * @brief The header at offset 0 of a shared-memory queue segment.
+     *
+     * Only fixed-width fields and lock-free atomics are stored, and nothing in
+     * the segment is a pointer, so every process can map it at any address.
+     */
+    struct shm_header {
+        // Line 0, written once by the creator before state becomes shm_ready
+        alignas(shm_line_size) std::uint64_t magic;         ///< shm_magic
+        std::uint32_t version;                              ///< Layout version of the segment
+        std::uint32_t element_size;                         ///< sizeof(T) of the creating process
+        std::uint64_t element_align;                        ///< alignof(T) of the creating process
+        std::uint64_t capacity;                             ///< Number of cells (a power of two)
+        std::uint64_t cell_size;                            ///< Distance between consecutive cells in bytes
+        std::atomic<std::uint32_t> state;                   ///< shm_initializing or shm_ready
+
+        alignas(shm_line_size) std::atomic<std::uint64_t> enqueue_pos;  ///< Next position claimed by producers
+        alignas(shm_line_size) std::atomic<std::uint64_t> dequeue_pos;  ///< Next position claimed by consumers
+    };
+
+    static_assert(sizeof(shm_header) == 3 * shm_line_size, "Unexpected shared-memory header layout");
+
+#if __cplusplus >= 201703L
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+                  "shm_circular_queue requires lock-free 32-bit and 64-bit atomics");
+#endif
+
+}
+
+/**
+ * @brief A bounded lock-free multi-producer/multi-consumer queue in a named POSIX shared-memory segment.
+ *
+ * One process creates the queue under a name and any number of processes on
+ * the same host attach to it by that name; producers and consumers in all of
+ * them may then call try_enqueue and try_dequeue concurrently. The algorithm
+ * is the one of mpmc_circular_queue (per-cell sequence counters, one
+ * compare-and-swap per operation), laid out inside the segment instead of on
+ * the heap:
+ *
+ * - offset 0: shm_header, three 128-byte lines holding the configuration and
+ *   ready state, the enqueue position and the dequeue position;
+ * - offset 384: capacity cells of cell_size bytes, each a 64-bit sequence
+ *   counter followed by the element bytes.
+ *
+ * The segment holds offsets and counters only, no pointers, so it is valid at
+ * whatever address each process maps it. The creator sizes the segment, lays
+ * out the cells and then publishes state = ready with a release store; an
+ * attaching process waits for that state and rejects segments whose magic,
+ * version or element layout differ from its own.
+ *
+ * A process that dies between claiming a position and publishing its cell
+ * leaves that cell claimed, which stalls the queue at that position. The queue
+ * does not block; consumers poll with try_dequeue.
+ *
+ * @tparam T The element type; must be trivially copyable, since its bytes are shared between processes.
+ */
+template<typename T>
+class shm_circular_queue {
+
+    static_assert(std::is_trivially_copyable<T>::value, "shm_circular_queue requires a trivially copyable type");
+
+    /**
+     * @brief A cell of the ring: the sequence counter followed by the element bytes.
+     */
+    struct cell {
+        std::atomic<std::uint64_t> sequence;                                ///< Lap-tagged state of the cell
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; ///< Element bytes
+    };
+
+    std::string name;                               ///< Name of the segment
+    char *base{};                                   ///< Start of the mapping in this process
+    std::size_t bytes{};                            ///< Size of the mapping
+    cqueue_detail::shm_header *header{};            ///< The header at the start of the mapping
+    cell *cells{};                                  ///< The cells after the header
+    std::size_t mask{};                             ///< Index mask of the cells
+    bool owner{};                                   ///< Whether this object created the segment and unlinks it
+
+public:
+
+    /**
+     * @brief Constructor that creates a new named segment and initializes an empty queue in it.
+     *
+     * The name is removed again when this object is destroyed; processes that
+     * are attached keep their mapping until they detach.
+     *
+     * @param name A POSIX shared-memory name such as "/orders".
+     * @param n The minimum number of elements the queue must hold; rounded up to a power of two of at least 2.
+     * @throws std::invalid_argument if the given size is 0.
+     * @throws std::system_error if a segment with that name already exists or cannot be created or mapped.
+     */
+    shm_circular_queue(const std::string &name, std::size_t n)
+        : name(name), owner(true) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        // With one cell, a filled cell would already carry the next lap's sequence and look free
+        const std::size_t capacity = cqueue_detail::next_power_of_two(n < 2 ? 2 : n);
+        bytes = sizeof(cqueue_detail::shm_header) + capacity * sizeof(cell);
+
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1) {
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot create the shared queue " + name));
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int error = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            CQUEUE_THROW(std::system_error(error, std::generic_category(), "Cannot size the shared queue " + name));
+        }
+        map(fd);
+
+        // The segment is zero-filled, so state already reads shm_initializing
+        header = ::new(static_cast<void *>(base)) cqueue_detail::shm_header();
+        header->magic = cqueue_detail::shm_magic;
+        header->version = cqueue_detail::shm_version;
+        header->element_size = static_cast<std::uint32_t>(sizeof(T));
+        header->element_align = alignof(T);
+        header->capacity = capacity;
+        header->cell_size = sizeof(cell);
+        cells = reinterpret_cast<cell *>(base + sizeof(cqueue_detail::shm_header));
+        mask = capacity - 1;
+        for (std::size_t i = 0; i < capacity; ++i) {
+            ::new(static_cast<void *>(&cells[i].sequence)) std::atomic<std::uint64_t>(i);
+        }
+        header->state.store(cqueue_detail::shm_ready, std::memory_order_release);
+    }
+
+    /**
+     * @brief Constructor that attaches to a queue created by another process (or object).
+     *
+     * Waits until the creator has finished initializing the segment.
+     *
+     * @param name The name the queue was created with.
+     * @param timeout How long to wait for the creator to finish initializing.
+     * @throws std::system_error if the segment does not exist or cannot be mapped.
+     * @throws std::runtime_error if the segment is not ready in time or was created with a different layout.
+     */
+    explicit shm_circular_queue(const std::string &name,
+                                std::chrono::milliseconds timeout = std::chrono::milliseconds(1000))
+        : name(name) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd == -1) {
+            CQUEUE_THROW(std::system_error(errno, std::generic_category(), "Cannot open the shared queue " + name));
+        }
+
+        // The creator sizes the segment right after creating it; wait for that first
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        struct stat info {};
+        while (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) < sizeof(cqueue_detail::shm_header)) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                close(fd);
+                CQUEUE_THROW(std::runtime_error("The shared queue " + name + " was not initialized in time"));
+            }
+            std::this_thread::yield();
+        }
+        bytes = static_cast<std::size_t>(info.st_size);
+        map(fd);
+        header = reinterpret_cast<cqueue_detail::shm_header *>(base);
+
+        while (header->state.load(std::memory_order_acquire) != cqueue_detail::shm_ready) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                detach();
+                CQUEUE_THROW(std::runtime_error("The shared queue " + name + " was not initialized in time"));
+            }
+            std::this_thread::yield();
+        }
+
+        // The capacity is bounded by the cells that fit in the segment, so a corrupt one cannot overflow
+        const std::uint64_t capacity = header->capacity;
+        if (header->magic != cqueue_detail::shm_magic || header->version != cqueue_detail::shm_version ||
+            header->element_size != sizeof(T) || header->element_align != alignof(T) ||
+            header->cell_size != sizeof(cell) || bytes < sizeof(cqueue_detail::shm_header) ||
+            capacity > (bytes - sizeof(cqueue_detail::shm_header)) / sizeof(cell) ||
+            !cqueue_detail::is_power_of_two(static_cast<std::size_t>(capacity))) {
+            detach();
+            CQUEUE_THROW(std::runtime_error("The shared queue " + name + " has a different layout"));
+        }
+        cells = reinterpret_cast<cell *>(base + sizeof(cqueue_detail::shm_header));
+        mask = static_cast<std::size_t>(capacity) - 1;
+    }
+
+    shm_circular_queue(const shm_circular_queue &) = delete;
+    shm_circular_queue &operator=(const shm_circular_queue &) = delete;
+
+    /**
+     * @brief Move constructor that takes over the mapping (and ownership of the name) of another queue.
+     *
+     * @param other The queue to move from; it is left detached.
+     */
+    shm_circular_queue(shm_circular_queue &&other) noexcept
+        : name(std::move(other.name)), base(other.base), bytes(other.bytes), header(other.header),
+          cells(other.cells), mask(other.mask), owner(other.owner) {
+        other.base = nullptr;
+        other.header = nullptr;
+        other.cells = nullptr;
+        other.owner = false;
+    }
+
+    /**
+     * @brief Destructor that unmaps the segment and, for the creator, removes its name.
+     */
+    ~shm_circular_queue() {
+        if (base) {
+            detach();
+        }
+        if (owner) {
+            shm_unlink(name.c_str());
+        }
+    }
+
+    /**
+     * @brief Removes a segment name left behind, for example by a creator that crashed.
+     *
+     * @param name The name of the segment.
+     * @return True if the name existed and was removed.
+     */
+    static bool remove(const std::string &name) {
+        return shm_unlink(name.c_str()) == 0;
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue.
+     *
+     * @param value The element to be added to the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(const T &value) {
+        std::uint64_t pos = header->enqueue_pos.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;) {
+            c = &cells[pos & mask];
+            const std::uint64_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(seq - pos);
+            if (diff == 0) {
+                if (header->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The cell still holds an element from the previous lap
+            } else {
+                pos = header->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        std::memcpy(static_cast<void *>(&c->storage), &value, sizeof(T));
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the front element of the queue.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool try_dequeue(T &out) {
+        std::uint64_t pos = header->dequeue_pos.load(std::memory_order_relaxed);
+        cell *c;
+        for (;;) {
+            c = &cells[pos & mask];
+            const std::uint64_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (header->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The cell has not been filled for this lap yet
+            } else {
+                pos = header->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        std::memcpy(static_cast<void *>(&out), &c->storage, sizeof(T));
+        c->sequence.store(pos + get_capacity(), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return get_size() == 0;
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == get_capacity();
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in the queue.
+     *
+     * Counts claimed positions, so elements that another process is still
+     * writing or reading are included.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        const std::uint64_t deq = header->dequeue_pos.load(std::memory_order_acquire);
+        const auto size = static_cast<std::int64_t>(header->enqueue_pos.load(std::memory_order_acquire) - deq);
+        if (size < 0) {
+            return 0;
+        }
+        return static_cast<std::size_t>(size) > get_capacity() ? get_capacity() : static_cast<std::size_t>(size);
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Returns the name of the shared-memory segment.
+     *
+     * @return The name the queue was created or attached with.
+     */
+    const std::string &get_name() const {
+        return name;
+    }
+
+private:
+
+    /**
+     * @brief Maps the whole segment and closes the descriptor, which the mapping does not need.
+     */
+    void map(int fd) {
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+            CQUEUE_THROW(std::system_error(error, std::generic_category(), "Cannot map the shared queue " + name));
+        }
+        base = static_cast<char *>(mapping);
+    }
+
+    void detach() {
+        munmap(base, bytes);
+        base = nullptr;
+        header = nullptr;
+        cells = nullptr;
+    }
+
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "queue_detail.hpp"
+#include "ring_span.hpp"
+
+/**
+ * @brief A fixed-capacity circular queue of records stored as one column per field.
+ *
+ * Where circular_queue<Tick> keeps whole records side by side, this queue
+ * keeps each field in its own ring, and all columns share one head and tail.
+ * A scan over one field then streams only that field's bytes through the
+ * cache, and column<I>() hands the field out as at most two contiguous spans
+ * that the window reductions (see ring_reductions.hpp) accept directly.
+ *
+ * Like circular_queue, enqueue overwrites the oldest record once the queue is
+ * full; try_enqueue rejects instead. Every field type must be trivially
+ * copyable, which covers the scalar columns this layout is meant for. The
+ * class is not thread-safe.
+ *
+ * @tparam Ts The field types, one column each.
+ */
+template<typename... Ts>
+class soa_circular_queue {
+
+    static_assert(sizeof...(Ts) >= 1, "soa_circular_queue requires at least one column");
+
+    template<bool... Bs>
+    using all_of = std::is_same<std::integer_sequence<bool, true, Bs...>, std::integer_sequence<bool, Bs..., true>>;
+    static_assert(all_of<std::is_trivially_copyable<Ts>::value...>::value,
+                  "soa_circular_queue requires trivially copyable fields");
+
+    using indices = std::index_sequence_for<Ts...>;
+
+    std::tuple<Ts *...> columns{};      ///< Storage of each column, all with the same number of slots
+    std::uint64_t head{}, tail{};       ///< Free-running counters of removed and added records
+    std::size_t capacity{}, mask{};     ///< Maximum number of records and index mask of the slots
+
+public:
+
+    /**
+     * @brief The type of the field in column I.
+     */
+    template<std::size_t I>
+    using column_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+    /**
+     * @brief Constructor that initializes the queue with a fixed size.
+     *
+     * @param n The maximum number of records the queue can hold.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit soa_circular_queue(std::size_t n)
+        : capacity(n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        mask = cqueue_detail::next_power_of_two(n) - 1;
+        CQUEUE_TRY {
+            allocate(indices());
+        } CQUEUE_CATCH_ALL {
+            deallocate(indices());
+            CQUEUE_RETHROW;
+        }
+    }
+
+    soa_circular_queue(const soa_circular_queue &) = delete;
+    soa_circular_queue &operator=(const soa_circular_queue &) = delete;
+
+    /**
+     * @brief Releases the column storage.
+     */
+    ~soa_circular_queue() {
+        deallocate(indices());
+    }
+
+    /**
+     * @brief Adds a record, overwriting the oldest one if the queue is full.
+     *
+     * @param fields The value of each field, in column order.
+     */
+    void enqueue(const Ts &... fields) {
+        if (is_full()) {
+            ++head;
+        }
+        store(slot_of(tail), indices(), fields...);
+        ++tail;
+    }
+
+    /**
+     * @brief Adds a record unless the queue is full.
+     *
+     * @param fields The value of each field, in column order.
+     * @return True if the record was added, false if the queue is full.
+     */
+    bool try_enqueue(const Ts &... fields) {
+        if (is_full()) {
+            return false;
+        }
+        store(slot_of(tail), indices(), fields...);
+        ++tail;
+        return true;
+    }
+
+    /**
+     * @brief Removes the front record.
+     *
+     * @param out Receive the value of each field, in column order.
+     * @return True if a record was removed, false if the queue is empty.
+     */
+    bool try_dequeue(Ts &... out) {
+        if (is_empty()) {
+            return false;
+        }
+        load(slot_of(head), indices(), out...);
+        ++head;
+        return true;
+    }
+
+    /**
+     * @brief Removes and returns the front record.
+     *
+     * @return The fields of the removed record.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    std::tuple<Ts...> dequeue() {
+        std::tuple<Ts...> record = peek();
+        ++head;
+        return record;
+    }
+
+    /**
+     * @brief Returns the front record without removing it.
+     *
+     * @return The fields of the front record.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    std::tuple<Ts...> peek() const {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return record_at(slot_of(head), indices());
+    }
+
+    /**
+     * @brief Removes the first k records, for example after scanning them through column().
+     *
+     * @param k The number of records to remove.
+     * @throws std::invalid_argument if k exceeds the current size.
+     */
+    void read_release(std::size_t k) {
+        if (k > get_size()) {
+            CQUEUE_THROW(std::invalid_argument("Cannot release more elements than the queue holds"));
+        }
+        head += k;
+    }
+
+    /**
+     * @brief Exposes one field of every record, oldest first, for reading.
+     *
+     * The column is returned as at most two contiguous spans, split at the
+     * wrap point; pass them to window_sum and the other reductions to scan the
+     * field alone. Use field to modify values in place.
+     *
+     * @tparam I The column to expose.
+     * @return The field values, in queue order.
+     */
+    template<std::size_t I>
+    ring_span_pair<const column_type<I>> column() const {
+        const column_type<I> *data = std::get<I>(columns);
+        const std::size_t size = get_size();
+        const std::size_t start = slot_of(head);
+        const std::size_t first_run = size < mask + 1 - start ? size : mask + 1 - start;
+        return ring_span_pair<const column_type<I>>(ring_span<const column_type<I>>(data + start, first_run),
+                                                    ring_span<const column_type<I>>(data, size - first_run));
+    }
+
+    /**
+     * @brief Accesses one field of a record at a position relative to the front, without a range check.
+     *
+     * @tparam I The column of the field.
+     * @param index The position of the record; must be less than get_size().
+     * @return A reference to the field.
+     */
+    template<std::size_t I>
+    column_type<I> &field(std::size_t index) noexcept {
+        return std::get<I>(columns)[slot_of(head + index)];
+    }
+
+    /**
+     * @brief Accesses one field of a record at a position relative to the front, without a range check.
+     *
+     * @tparam I The column of the field.
+     * @param index The position of the record; must be less than get_size().
+     * @return A const reference to the field.
+     */
+    template<std::size_t I>
+    const column_type<I> &field(std::size_t index) const noexcept {
+        return std::get<I>(columns)[slot_of(head + index)];
+    }
+
+    /**
+     * @brief Removes every record.
+     */
+    void clear() {
+        head = tail = 0;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return head == tail;
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == capacity;
+    }
+
+    /**
+     * @brief Returns the number of records in the queue.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        return static_cast<std::size_t>(tail - head);
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue.
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Returns the number of columns.
+     *
+     * @return sizeof...(Ts).
+     */
+    static constexpr std::size_t get_column_count() {
+        return sizeof...(Ts);
+    }
+
+private:
+
+    using swallow = int[];
+
+    std::size_t slot_of(std::uint64_t counter) const {
+        return static_cast<std::size_t>(counter & mask);
+    }
+
+    template<std::size_t... Is>
+    void allocate(std::index_sequence<Is...>) {
+        (void) swallow{0, ((void) (std::get<Is>(columns) = std::allocator<Ts>().allocate(mask + 1)), 0)...};
+    }
+
+    template<std::size_t... Is>
+    void deallocate(std::index_sequence<Is...>) {
+        (void) swallow{0, ((void) (std::get<Is>(columns) != nullptr
+                                   ? std::allocator<Ts>().deallocate(std::get<Is>(columns), mask + 1)
+                                   : (void) 0), 0)...};
+    }
+
+    template<std::size_t... Is>
+    void store(std::size_t slot, std::index_sequence<Is...>, const Ts &... fields) {
+        (void) swallow{0, ((void) ::new(static_cast<void *>(std::get<Is>(columns) + slot)) Ts(fields), 0)...};
+    }
+
+    template<std::size_t... Is>
+    void load(std::size_t slot, std::index_sequence<Is...>, Ts &... out) const {
+        (void) swallow{0, ((void) (out = std::get<Is>(columns)[slot]), 0)...};
+    }
+
+    template<std::size_t... Is>
+    std::tuple<Ts...> record_at(std::size_t slot, std::index_sequence<Is...>) const {
+        return std::tuple<Ts...>(std::get<Is>(columns)[slot]...);
+    }
+
+};
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+
+#include "queue_detail.hpp"
+#include "queue_wait.hpp"
+
+/**
+ * @brief A lock-free single-producer/single-consumer circular queue.
+ *
+ * This variant of circular_queue is meant for exactly one producer thread and
+ * one consumer thread. The producer only writes the tail index and the consumer
+ * only writes the head index; each index sits on its own cache line and is
+ * published with release stores and observed with acquire loads, so no mutex
+ * is needed around enqueue or dequeue.
+ *
+ * Unlike circular_queue, a full queue never overwrites the oldest element:
+ * overwriting would require the producer to modify the consumer's index.
+ * Instead, try_enqueue reports failure and leaves the queue untouched.
+ *
+ * The read-only configuration, the producer's state and the consumer's state
+ * each occupy their own cache line. Each side also keeps a private copy of the
+ * other side's index and only reloads the shared one when that copy says the
+ * queue is full (producer) or empty (consumer), so while the queue is neither,
+ * an operation touches no line the other side writes apart from the slot.
+ *
+ * The requested capacity is rounded up to the next power of two so slot
+ * indices can be computed with a mask instead of a division.
+ *
+ * With Blocking set to true the queue also offers wait_enqueue and
+ * wait_dequeue, which spin briefly and then park the calling thread until the
+ * other side makes progress or a timeout expires. Every successful operation
+ * then checks for parked threads with one fence and one load, and only issues
+ * a wake-up when a waiter is registered. With Blocking false (the default)
+ * that check compiles away.
+ *
+ * @tparam T The type of elements in the queue (e.g., int, std::string).
+ * @tparam Blocking Whether the queue supports the blocking wait_ operations.
+ */
+template<typename T, bool Blocking = false>
+class spsc_circular_queue {
+
+    using event_type = typename std::conditional<Blocking, cqueue_detail::event_count,
+        cqueue_detail::null_event_count>::type;
+
+    // Read-only after construction; shared by both sides without invalidations
+    alignas(cqueue_detail::cache_line_size) T *arr{};                   ///< Uninitialized slot storage
+    std::size_t capacity{}, mask{};                                     ///< Number of slots and index mask
+    std::allocator<T> allocator;                                        ///< Allocator for the slot storage
+
+    // Producer line
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> tail{0};  ///< Next slot to write, published to the consumer
+    std::size_t cached_head{0};                                         ///< Producer's last observed value of head
+
+    // Consumer line
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::size_t> head{0};  ///< Next slot to read, published to the producer
+    std::size_t cached_tail{0};                                         ///< Consumer's last observed value of tail
+
+    event_type not_empty;                                               ///< Wakes a consumer parked in wait_dequeue
+    event_type not_full;                                                ///< Wakes a producer parked in wait_enqueue
+
+public:
+
+    /**
+     * @brief Constructor that initializes the queue with a fixed size.
+     *
+     * @param n The minimum number of elements the queue must hold; rounded up to a power of two.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit spsc_circular_queue(std::size_t n) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        capacity = cqueue_detail::next_power_of_two(n);
+        mask = capacity - 1;
+        arr = allocator.allocate(capacity);
+    }
+
+    spsc_circular_queue(const spsc_circular_queue &) = delete;
+    spsc_circular_queue &operator=(const spsc_circular_queue &) = delete;
+
+    /**
+     * @brief Destroys the remaining elements and releases the slot storage.
+     *
+     * Must not run concurrently with the producer or the consumer.
+     */
+    ~spsc_circular_queue() {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        for (; h != t; ++h) {
+            arr[h & mask].~T();
+        }
+        allocator.deallocate(arr, capacity);
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue. Producer only.
+     *
+     * @param value The element to be added to the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(const T &value) {
+        return try_emplace(value);
+    }
+
+    /**
+     * @brief Moves an element into the rear of the queue. Producer only.
+     *
+     * @param value The element to be moved into the queue.
+     * @return True if the element was added, false if the queue is full.
+     */
+    bool try_enqueue(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element in place at the rear of the queue. Producer only.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return True if the element was added, false if the queue is full.
+     */
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == capacity) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == capacity) {
+                return false;
+            }
+        }
+        ::new(static_cast<void *>(arr + (t & mask))) T(std::forward<Args>(args)...);
+        tail.store(t + 1, std::memory_order_release);
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the front element of the queue. Consumer only.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool try_dequeue(T &out) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        T &slot = arr[h & mask];
+        out = std::move(slot);
+        slot.~T();
+        head.store(h + 1, std::memory_order_release);
+        not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Copies as many elements of a contiguous range as fit into the queue. Producer only.
+     *
+     * The elements are copied in at most two runs (one on each side of the wrap
+     * point) and published to the consumer with a single tail update.
+     *
+     * @param first Pointer to the first element to add.
+     * @param n The number of elements to add.
+     * @return The number of elements added, which is less than n if the queue filled up.
+     */
+    std::size_t try_enqueue_bulk(const T *first, std::size_t n) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t room = capacity - (t - cached_head);
+        if (room < n) {
+            cached_head = head.load(std::memory_order_acquire);
+            room = capacity - (t - cached_head);
+        }
+        const std::size_t count = n < room ? n : room;
+        if (count == 0) {
+            return 0;
+        }
+
+        const std::size_t start = t & mask;
+        const std::size_t first_run = count < capacity - start ? count : capacity - start;
+        std::uninitialized_copy(first, first + first_run, arr + start);
+        CQUEUE_TRY {
+            std::uninitialized_copy(first + first_run, first + count, arr);
+        } CQUEUE_CATCH_ALL {
+            for (std::size_t i = 0; i < first_run; ++i) {
+                arr[start + i].~T();
+            }
+            CQUEUE_RETHROW;
+        }
+
+        tail.store(t + count, std::memory_order_release);
+        not_empty.notify_all();
+        return count;
+    }
+
+    /**
+     * @brief Removes up to max elements from the front of the queue. Consumer only.
+     *
+     * The elements are moved out in at most two runs and the slots are handed
+     * back to the producer with a single head update.
+     *
+     * @param out Pointer to the first of at least max elements that receive the removed values.
+     * @param max The maximum number of elements to remove.
+     * @return The number of elements removed.
+     */
+    std::size_t try_dequeue_bulk(T *out, std::size_t max) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t available = cached_tail - h;
+        if (available < max) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            available = cached_tail - h;
+        }
+        const std::size_t count = max < available ? max : available;
+        if (count == 0) {
+            return 0;
+        }
+
+        const std::size_t start = h & mask;
+        const std::size_t first_run = count < capacity - start ? count : capacity - start;
+        std::move(arr + start, arr + start + first_run, out);
+        std::move(arr, arr + (count - first_run), out + first_run);
+        for (std::size_t i = 0; i < count; ++i) {
+            arr[(start + i) & mask].~T();
+        }
+
+        head.store(h + count, std::memory_order_release);
+        not_full.notify_all();
+        return count;
+    }
+
+    /**
+     * @brief Adds an element to the rear of the queue, waiting while it is full. Producer only.
+     *
+     * Spins for a bounded number of attempts and then parks the thread until a
+     * consumer frees a slot or the timeout expires. The value is only consumed
+     * if the call succeeds.
+     *
+     * @param value The element to be added to the queue.
+     * @param timeout The maximum time to wait.
+     * @return True if the element was added, false if the timeout expired.
+     */
+    template<typename U, typename Rep, typename Period>
+    bool wait_enqueue(U &&value, const std::chrono::duration<Rep, Period> &timeout) {
+        static_assert(Blocking, "wait_enqueue requires a queue with Blocking = true");
+        return cqueue_detail::spin_then_park(not_full, timeout, [&] {
+            return try_emplace(std::forward<U>(value));
+        });
+    }
+
+    /**
+     * @brief Removes the front element of the queue, waiting while it is empty. Consumer only.
+     *
+     * Spins for a bounded number of attempts and then parks the thread until a
+     * producer adds an element or the timeout expires.
+     *
+     * @param out Receives the removed element.
+     * @param timeout The maximum time to wait.
+     * @return True if an element was removed, false if the timeout expired.
+     */
+    template<typename Rep, typename Period>
+    bool wait_dequeue(T &out, const std::chrono::duration<Rep, Period> &timeout) {
+        static_assert(Blocking, "wait_dequeue requires a queue with Blocking = true");
+        return cqueue_detail::spin_then_park(not_empty, timeout, [&] {
+            return try_dequeue(out);
+        });
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * The result is exact when called by the consumer and a snapshot otherwise.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * The result is exact when called by the producer and a snapshot otherwise.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return get_size() == capacity;
+    }
+
+    /**
+     * @brief Returns the number of elements currently in the queue.
+     *
+     * When called concurrently with the producer and consumer the value is a
+     * snapshot that may already be outdated.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        const std::size_t h = head.load(std::memory_order_acquire);
+        const std::size_t size = tail.load(std::memory_order_acquire) - h;
+        return size > capacity ? capacity : size;
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return capacity;
+    }
+
+};
@@ -0,0 +1,496 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "queue_detail.hpp"
+#include "queue_logger.hpp"
+#include "ring_iterator.hpp"
+
+/**
+ * @brief A circular queue whose capacity is fixed at compile time.
+ *
+ * This is the compile-time counterpart of circular_queue. The capacity N must
+ * be a power of two, the elements live inline in the object instead of a heap
+ * allocation, and every index is reduced with a constant mask (N - 1), so no
+ * operation performs an integer division. The head and tail are free-running
+ * counters; their difference is the current size.
+ *
+ * As in circular_queue, the inline slots are raw storage: an element is
+ * constructed in its slot when it is added and destroyed as soon as it is
+ * dequeued, overwritten or cleared, so T does not need to be default
+ * constructible and discarded elements release their resources at once.
+ *
+ * As with circular_queue, enqueueing into a full queue overwrites the oldest
+ * element, and events are reported to a compile-time logger policy.
+ *
+ * @tparam T The type of elements in the queue (e.g., int, std::string).
+ * @tparam N The capacity of the queue; must be a power of two.
+ * @tparam Logger The logger policy invoked for queue events (see queue_logger.hpp).
+ */
+template<typename T, std::size_t N, typename Logger = no_log>
+class static_circular_queue : private Logger {
+
+    static_assert(cqueue_detail::is_power_of_two(N), "static_circular_queue capacity must be a power of two");
+
+    static constexpr std::size_t mask = N - 1;          ///< Index mask derived from the capacity
+
+    /// Whether try_dequeue(T&) can neither throw from moving the element nor from logging it
+    static constexpr bool nothrow_dequeue = std::is_nothrow_move_assignable<T>::value &&
+        noexcept(std::declval<Logger &>()(queue_event::dequeued, static_cast<const T *>(nullptr), std::size_t()));
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];  ///< Uninitialized inline slots
+    std::size_t head{}, tail{};                         ///< Free-running counters for the front and rear of the queue
+
+public:
+
+    using value_type = T;
+    using iterator = ring_iterator<T>;
+    using const_iterator = ring_iterator<const T>;
+
+    /**
+     * @brief Constructor that initializes an empty queue.
+     *
+     * @param logger The logger policy instance that receives queue events.
+     */
+    explicit static_circular_queue(const Logger &logger = Logger())
+        : Logger(logger) {
+    }
+
+    /**
+     * @brief Copy constructor that copies the elements of another queue, front first.
+     *
+     * @param other The queue to copy.
+     */
+    static_circular_queue(const static_circular_queue &other)
+        : Logger(other) {
+        append_all(other);
+    }
+
+    /**
+     * @brief Move constructor that moves the elements of another queue, front first.
+     *
+     * The other queue keeps its moved-from elements until it is cleared or destroyed.
+     *
+     * @param other The queue to move from.
+     */
+    static_circular_queue(static_circular_queue &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : Logger(std::move(static_cast<Logger &>(other))) {
+        append_all(std::move(other));
+    }
+
+    /**
+     * @brief Copy assignment that replaces the elements with copies of those of another queue.
+     *
+     * @param other The queue to copy.
+     * @return A reference to this queue.
+     */
+    static_circular_queue &operator=(const static_circular_queue &other) {
+        if (this != &other) {
+            destroy_elements();
+            static_cast<Logger &>(*this) = other;
+            append_all(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment that replaces the elements with those moved from another queue.
+     *
+     * @param other The queue to move from.
+     * @return A reference to this queue.
+     */
+    static_circular_queue &operator=(static_circular_queue &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            destroy_elements();
+            static_cast<Logger &>(*this) = std::move(static_cast<Logger &>(other));
+            append_all(std::move(other));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroys the remaining elements.
+     */
+    ~static_circular_queue() {
+        destroy_elements();
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * @return True if the queue is full, false otherwise.
+     */
+    bool is_full() const {
+        return tail - head == N;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return tail == head;
+    }
+
+    /**
+     * @brief Copies an element to the rear of the queue.
+     *
+     * If the queue is full, the oldest element (front) will be overwritten.
+     *
+     * @param value The element to be added to the queue.
+     */
+    void enqueue(const T &value) {
+        emplace(value);
+    }
+
+    /**
+     * @brief Moves an element to the rear of the queue.
+     *
+     * If the queue is full, the oldest element (front) will be overwritten.
+     *
+     * @param value The element to be moved into the queue.
+     */
+    void enqueue(T &&value) {
+        emplace(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element from the given arguments and stores it at the rear of the queue.
+     *
+     * If the queue is full, the oldest element (front) is overwritten. The new
+     * element is then built before the oldest one is destroyed, so a throwing
+     * constructor leaves the queue unchanged.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return A reference to the newly added element.
+     */
+    template<typename... Args>
+    T &emplace(Args &&... args) {
+        if (is_full()) {
+            T value(std::forward<Args>(args)...);
+            log(queue_event::full, nullptr, 0);
+            log(queue_event::overwritten, slot(head), 1);
+            pop_front();
+            return construct_at_rear(std::move(value));
+        }
+        return construct_at_rear(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Removes and returns the front element of the queue.
+     *
+     * @return The element removed from the front of the queue.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T dequeue() {
+        if (is_empty()) {
+            log(queue_event::empty, nullptr, 0);
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+
+        T value = std::move(*slot(head));
+        pop_front();
+
+        log(queue_event::dequeued, &value, 1);
+
+        return value;
+    }
+
+    /**
+     * @brief Removes the front element of the queue into out, if there is one.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the queue was empty.
+     */
+    bool try_dequeue(T &out) noexcept(nothrow_dequeue) {
+        if (is_empty()) {
+            log(queue_event::empty, nullptr, 0);
+            return false;
+        }
+
+        out = std::move(*slot(head));
+        pop_front();
+
+        log(queue_event::dequeued, &out, 1);
+        return true;
+    }
+
+#if CQUEUE_HAS_OPTIONAL
+    /**
+     * @brief Removes and returns the front element of the queue, if there is one.
+     *
+     * @return The removed element, or an empty optional if the queue was empty.
+     */
+    std::optional<T> try_dequeue() {
+        if (is_empty()) {
+            log(queue_event::empty, nullptr, 0);
+            return std::nullopt;
+        }
+
+        std::optional<T> value(std::move(*slot(head)));
+        pop_front();
+
+        log(queue_event::dequeued, &*value, 1);
+        return value;
+    }
+#endif
+
+    /**
+     * @brief Retrieves the front element without removing it.
+     *
+     * @return The front element of the queue.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    T peek() const {
+        if (is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return *slot(head);
+    }
+
+    /**
+     * @brief Returns the front element without removing it, if there is one.
+     *
+     * @return A pointer to the front element, or nullptr if the queue is empty.
+     */
+    T *try_peek() noexcept {
+        return is_empty() ? nullptr : slot(head);
+    }
+
+    /**
+     * @brief Returns the front element without removing it, if there is one.
+     *
+     * @return A pointer to the front element, or nullptr if the queue is empty.
+     */
+    const T *try_peek() const noexcept {
+        return is_empty() ? nullptr : slot(head);
+    }
+
+    /**
+     * @brief Displays the current elements of the queue.
+     */
+    void display() const {
+        if (is_empty()) {
+            std::cout << "Queue is empty" << std::endl;
+            return;
+        }
+
+        std::cout << "Queue elements: ";
+        for (std::size_t i = head; i != tail; ++i) {
+            std::cout << *slot(i) << " ";
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Clears the queue by destroying every element.
+     */
+    void clear() {
+        const std::size_t discarded = tail - head;
+        destroy_elements();
+        head = tail = 0;
+        log(queue_event::cleared, nullptr, discarded);
+    }
+
+    /**
+     * @brief Retrieves all elements currently in the queue as a vector.
+     *
+     * @return A vector containing all elements in the queue, front first.
+     */
+    std::vector<T> get_all_elements() const {
+        return std::vector<T>(begin(), end());
+    }
+
+    /**
+     * @brief Retrieves the element at a specific index in the queue.
+     *
+     * @param index The index of the element to retrieve (0-based, relative to the front).
+     * @return The element at the specified index.
+     * @throws std::out_of_range if the index is invalid.
+     */
+    T get_element_at(std::size_t index) const {
+        if (index >= tail - head) {
+            CQUEUE_THROW(std::out_of_range("Index out of range"));
+        }
+        return *slot(head + index);
+    }
+
+    /**
+     * @brief Accesses the element at a position relative to the front, without a range check.
+     *
+     * @param index The position of the element; must be less than get_size().
+     * @return A reference to the element.
+     */
+    T &operator[](std::size_t index) noexcept {
+        return *slot(head + index);
+    }
+
+    /**
+     * @brief Accesses the element at a position relative to the front, without a range check.
+     *
+     * @param index The position of the element; must be less than get_size().
+     * @return A const reference to the element.
+     */
+    const T &operator[](std::size_t index) const noexcept {
+        return *slot(head + index);
+    }
+
+    /**
+     * @brief Returns an iterator to the front element.
+     *
+     * @return An iterator that walks the elements from the front to the rear.
+     */
+    iterator begin() noexcept {
+        return iterator(data(), mask, head);
+    }
+
+    /**
+     * @brief Returns an iterator past the rear element.
+     *
+     * @return The end iterator.
+     */
+    iterator end() noexcept {
+        return iterator(data(), mask, tail);
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(data(), mask, head);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(data(), mask, tail);
+    }
+
+    /**
+     * @brief Returns the current size of the queue.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        return tail - head;
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue.
+     */
+    static constexpr std::size_t get_capacity() {
+        return N;
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters kept by the logger policy.
+     *
+     * Only available when the policy provides stats(), such as stats_log (see
+     * queue_stats.hpp). The snapshot may be taken from any thread.
+     *
+     * @return The counters of the logger policy.
+     */
+    template<typename L = Logger>
+    auto stats() const noexcept -> decltype(std::declval<const L &>().stats()) {
+        return static_cast<const Logger &>(*this).stats();
+    }
+
+private:
+
+    T *data() noexcept {
+        return reinterpret_cast<T *>(storage);
+    }
+
+    const T *data() const noexcept {
+        return reinterpret_cast<const T *>(storage);
+    }
+
+    T *slot(std::size_t counter) noexcept {
+        return data() + (counter & mask);
+    }
+
+    const T *slot(std::size_t counter) const noexcept {
+        return data() + (counter & mask);
+    }
+
+    /**
+     * @brief Constructs an element in the slot after the current rear; the queue must not be full.
+     *
+     * @param args Arguments forwarded to the constructor of T.
+     * @return A reference to the newly added element.
+     */
+    template<typename... Args>
+    T &construct_at_rear(Args &&... args) {
+        T *added = ::new(static_cast<void *>(slot(tail))) T(std::forward<Args>(args)...);
+        ++tail;
+
+        log(queue_event::enqueued, added, 1);
+        return *added;
+    }
+
+    /**
+     * @brief Destroys the front element and advances past it.
+     */
+    void pop_front() noexcept {
+        slot(head)->~T();
+        ++head;
+    }
+
+    /**
+     * @brief Destroys every element without reporting an event; the counters are left as they are.
+     */
+    void destroy_elements() noexcept {
+        for (std::size_t i = head; i != tail; ++i) {
+            slot(i)->~T();
+        }
+    }
+
+    /**
+     * @brief Copies or moves every element of another queue to the rear of this empty one, front first.
+     *
+     * If an element throws while being constructed, the elements added so far are destroyed.
+     */
+    template<typename Queue>
+    void append_all(Queue &&other) {
+        head = tail = 0;
+        CQUEUE_TRY {
+            for (std::size_t i = other.head; i != other.tail; ++i) {
+                using source = typename std::conditional<std::is_lvalue_reference<Queue>::value, const T &, T &&>::type;
+                ::new(static_cast<void *>(slot(tail))) T(static_cast<source>(*other.slot(i)));
+                ++tail;
+            }
+        } CQUEUE_CATCH_ALL {
+            destroy_elements();
+            head = tail = 0;
+            CQUEUE_RETHROW;
+        }
+    }
+
+    /**
+     * @brief Reports an event to the logger policy.
+     *
+     * @param event The kind of event.
+     * @param values The affected value(s), or nullptr.
+     * @param count The number of values, or the event-specific quantity.
+     */
+    void log(queue_event event, const T *values, std::size_t count) {
+        static_cast<Logger &>(*this)(event, values, count);
+    }
+
+};
+
+#if defined(__cpp_lib_ranges)
+static_assert(std::ranges::random_access_range<static_circular_queue<int, 4>>);
+#endif
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "circular_queue.hpp"
+#include "ring_reductions.hpp"
+
+/**
+ * @brief A bounded queue of timestamped elements that evicts by age.
+ *
+ * Every element is stored with the time it was added, as a raw tick count of
+ * Clock, in a second ring that runs in lockstep with the values. Keeping the
+ * timestamps apart from the values (structure of arrays) packs them densely,
+ * and because they are non-decreasing, evict_older_than finds the cut-off
+ * with a galloping binary search from the front and then drops everything
+ * before it at once. Evicting k elements costs O(log k) timestamp reads
+ * instead of a scan over all k, and O(1) in the common case where only a few
+ * have expired.
+ *
+ * Once the queue is full, adding an element overwrites the oldest one, like
+ * circular_queue, so the capacity bounds memory even if eviction stalls.
+ *
+ * With Aggregates set to true, the values are held in a sliding_window and
+ * sum, mean, min and max are kept up to date as elements are added and
+ * evicted; that requires an arithmetic T. The class is not thread-safe.
+ *
+ * @tparam T The type of elements in the queue.
+ * @tparam Clock The clock the timestamps come from; std::chrono::steady_clock by default.
+ * @tparam Aggregates Whether to maintain sum, mean, min and max.
+ */
+template<typename T, typename Clock = std::chrono::steady_clock, bool Aggregates = false>
+class timed_circular_queue {
+
+public:
+
+    using time_point = typename Clock::time_point;
+    using duration = typename Clock::duration;
+
+private:
+
+    using rep = typename duration::rep;
+    using value_store = typename std::conditional<Aggregates, sliding_window<T>, circular_queue<T>>::type;
+
+    value_store values;                 ///< The elements, oldest first
+    circular_queue<rep> stamps;         ///< Tick count of each element's time, in the same order
+
+public:
+
+    /**
+     * @brief Constructor that creates an empty queue.
+     *
+     * @param n The maximum number of elements the queue holds.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit timed_circular_queue(std::size_t n)
+        : values(n), stamps(n) {
+    }
+
+    /**
+     * @brief Adds an element stamped with the current time of Clock.
+     *
+     * @param value The element to be added.
+     */
+    void push(const T &value) {
+        push(value, Clock::now());
+    }
+
+    /**
+     * @brief Adds an element with the given timestamp, overwriting the oldest element if the queue is full.
+     *
+     * @param value The element to be added.
+     * @param time The time of the element; not earlier than the newest timestamp in the queue.
+     * @throws std::invalid_argument if time is earlier than the newest timestamp.
+     */
+    void push(const T &value, time_point time) {
+        const rep ticks = time.time_since_epoch().count();
+        if (!stamps.is_empty() && ticks < newest_ticks()) {
+            CQUEUE_THROW(std::invalid_argument("Timestamps must not decrease"));
+        }
+        add(value, std::integral_constant<bool, Aggregates>());
+        stamps.enqueue(ticks);
+    }
+
+    /**
+     * @brief Removes every element stamped earlier than the given time.
+     *
+     * @param time The cut-off; elements stamped at or after it stay.
+     * @return The number of elements removed.
+     */
+    std::size_t evict_older_than(time_point time) {
+        const rep ticks = time.time_since_epoch().count();
+        const std::size_t size = stamps.get_size();
+        if (size == 0 || stamps[0] >= ticks) {
+            return 0;
+        }
+
+        // Gallop from the front to bracket the cut-off, then bisect the bracket
+        std::size_t lo = 0, hi = 1;
+        while (hi < size && stamps[hi] < ticks) {
+            lo = hi;
+            hi = hi * 2 < size ? hi * 2 : size;
+        }
+        // stamps[lo] < ticks, and hi is size or the first galloped index at or after the cut-off
+        while (hi - lo > 1) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (stamps[mid] < ticks) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const std::size_t count = hi;
+        evict(count, std::integral_constant<bool, Aggregates>());
+        stamps.read_release(count);
+        return count;
+    }
+
+    /**
+     * @brief Removes every element older than the given age, measured from the current time of Clock.
+     *
+     * @param age The width of the window to keep, such as std::chrono::seconds(5).
+     * @return The number of elements removed.
+     */
+    std::size_t evict_expired(duration age) {
+        return evict_older_than(Clock::now() - age);
+    }
+
+    /**
+     * @brief Returns the timestamp of the oldest element.
+     *
+     * @return The time the front element was added.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    time_point oldest_time() const {
+        if (stamps.is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return time_point(duration(stamps.peek()));
+    }
+
+    /**
+     * @brief Returns the timestamp of the newest element.
+     *
+     * @return The time the rear element was added.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    time_point newest_time() const {
+        if (stamps.is_empty()) {
+            CQUEUE_THROW(std::underflow_error("Queue is empty"));
+        }
+        return time_point(duration(newest_ticks()));
+    }
+
+    /**
+     * @brief Returns the sum of the elements.
+     *
+     * Only available with Aggregates = true.
+     *
+     * @return The running sum, or T() for an empty queue.
+     */
+    template<bool A = Aggregates, typename = typename std::enable_if<A>::type>
+    T sum() const {
+        return values.sum();
+    }
+
+    /**
+     * @brief Returns the arithmetic mean of the elements.
+     *
+     * Only available with Aggregates = true.
+     *
+     * @return The mean as a double.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    template<bool A = Aggregates, typename = typename std::enable_if<A>::type>
+    double mean() const {
+        return values.mean();
+    }
+
+    /**
+     * @brief Returns the smallest element.
+     *
+     * Only available with Aggregates = true.
+     *
+     * @return The minimum.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    template<bool A = Aggregates, typename = typename std::enable_if<A>::type>
+    T min() const {
+        return values.min();
+    }
+
+    /**
+     * @brief Returns the largest element.
+     *
+     * Only available with Aggregates = true.
+     *
+     * @return The maximum.
+     * @throws std::underflow_error if the queue is empty.
+     */
+    template<bool A = Aggregates, typename = typename std::enable_if<A>::type>
+    T max() const {
+        return values.max();
+    }
+
+    /**
+     * @brief Removes every element.
+     */
+    void clear() {
+        values.clear();
+        stamps.clear();
+    }
+
+    /**
+     * @brief Returns the elements, oldest first.
+     *
+     * @return The queue holding the values.
+     */
+    const circular_queue<T> &get_values() const {
+        return queue_of(std::integral_constant<bool, Aggregates>());
+    }
+
+    /**
+     * @brief Returns the timestamps as raw tick counts of Clock, oldest first.
+     *
+     * @return The queue holding the timestamps.
+     */
+    const circular_queue<rep> &get_timestamps() const {
+        return stamps;
+    }
+
+    /**
+     * @brief Checks if the queue is empty.
+     *
+     * @return True if the queue is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return stamps.is_empty();
+    }
+
+    /**
+     * @brief Checks if the queue is full.
+     *
+     * @return True if the next push overwrites the oldest element, false otherwise.
+     */
+    bool is_full() const {
+        return stamps.is_full();
+    }
+
+    /**
+     * @brief Returns the number of elements in the queue.
+     *
+     * @return The current size of the queue.
+     */
+    std::size_t get_size() const {
+        return stamps.get_size();
+    }
+
+    /**
+     * @brief Returns the maximum capacity of the queue.
+     *
+     * @return The capacity of the queue.
+     */
+    std::size_t get_capacity() const {
+        return stamps.get_capacity();
+    }
+
+private:
+
+    rep newest_ticks() const {
+        return stamps[stamps.get_size() - 1];
+    }
+
+    void add(const T &value, std::true_type) {
+        values.push(value);
+    }
+
+    void add(const T &value, std::false_type) {
+        values.enqueue(value);
+    }
+
+    void evict(std::size_t count, std::true_type) {
+        values.evict(count);
+    }
+
+    void evict(std::size_t count, std::false_type) {
+        values.read_release(count);
+    }
+
+    const circular_queue<T> &queue_of(std::true_type) const {
+        return values.get_values();
+    }
+
+    const circular_queue<T> &queue_of(std::false_type) const {
+        return values;
+    }
+
+};
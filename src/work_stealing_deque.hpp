@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "queue_detail.hpp"
+
+/**
+ * @brief A lock-free Chase-Lev work-stealing deque for task schedulers.
+ *
+ * One owner thread pushes and pops at the bottom; any number of thief threads
+ * steal from the top. The owner's operations touch only its own end and need
+ * no compare-and-swap except when it races a thief for the very last element;
+ * a steal costs one compare-and-swap on the top index. The memory orderings
+ * follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * The ring starts at the requested power-of-two capacity and doubles when a
+ * push finds it full. Growing copies the live elements into a new ring and
+ * publishes it with a single release store, so thieves keep stealing
+ * throughout: a thief still holding the old ring reads the same values from
+ * it, because the owner never writes to a ring once it has been replaced.
+ * Replaced rings are therefore kept until the deque is destroyed; together
+ * they are smaller than the current ring.
+ *
+ * A thief reads the element before its compare-and-swap decides whether the
+ * steal counts, so slots are std::atomic<T> and T must be trivially copyable
+ * and lock-free as an atomic: task pointers, indices or small handles.
+ *
+ * Like the other concurrent variants, the top, the bottom and the ring pointer
+ * each sit on their own cache line.
+ *
+ * @tparam T The element type, typically a pointer to a task.
+ */
+template<typename T>
+class work_stealing_deque {
+
+    static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque requires a trivially copyable type");
+#if __cplusplus >= 201703L
+    static_assert(std::atomic<T>::is_always_lock_free, "work_stealing_deque requires a lock-free std::atomic<T>");
+#endif
+
+    /**
+     * @brief A power-of-two ring of atomic slots, indexed by the free-running deque positions.
+     */
+    struct ring {
+        std::size_t mask;                           ///< Index mask of the slots
+        std::unique_ptr<std::atomic<T>[]> slots;    ///< The slots
+
+        explicit ring(std::size_t capacity)
+            : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {
+        }
+
+        T load(std::int64_t i) const noexcept {
+            return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        void store(std::int64_t i, T value) noexcept {
+            slots[static_cast<std::size_t>(i) & mask].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::int64_t> top{0};      ///< Next position thieves steal from
+    alignas(cqueue_detail::cache_line_size) std::atomic<std::int64_t> bottom{0};   ///< Next position the owner pushes to
+    alignas(cqueue_detail::cache_line_size) std::atomic<ring *> active{nullptr};   ///< The ring in use
+    std::vector<std::unique_ptr<ring>> rings;       ///< Every ring allocated so far, the active one last; owner only
+
+public:
+
+    /**
+     * @brief Constructor that creates an empty deque.
+     *
+     * @param n The initial capacity; rounded up to a power of two. The deque grows beyond it as needed.
+     * @throws std::invalid_argument if the given size is 0.
+     */
+    explicit work_stealing_deque(std::size_t n = 1024) {
+        if (n == 0) {
+            CQUEUE_THROW(std::invalid_argument("Queue capacity must be greater than 0."));
+        }
+        rings.emplace_back(new ring(cqueue_detail::next_power_of_two(n)));
+        active.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque &) = delete;
+    work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+
+    /**
+     * @brief Adds an element at the bottom, growing the ring if it is full. Owner only.
+     *
+     * @param value The element to add.
+     * @throws std::bad_alloc if the ring has to grow and no memory is available.
+     */
+    void push(T value) {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = top.load(std::memory_order_acquire);
+        ring *r = active.load(std::memory_order_relaxed);
+        if (static_cast<std::size_t>(b - t) > r->mask) {
+            r = grow(r, t, b);
+        }
+        r->store(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Removes the element at the bottom, the one pushed last. Owner only.
+     *
+     * @param out Receives the removed element.
+     * @return True if an element was removed, false if the deque is empty or a thief took the last element.
+     */
+    bool try_pop(T &out) {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        ring *r = active.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty: undo the reservation
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        const T value = r->load(b);
+        if (t == b) {
+            // The last element: race the thieves for it
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+        out = value;
+        return true;
+    }
+
+    /**
+     * @brief Removes the element at the top, the oldest one. Any thread.
+     *
+     * A false result means the deque looked empty or another thief (or the
+     * owner) took the element first; under contention the caller can retry or
+     * move on to another victim.
+     *
+     * @param out Receives the stolen element.
+     * @return True if an element was stolen, false otherwise.
+     */
+    bool try_steal(T &out) {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        ring *r = active.load(std::memory_order_acquire);
+        const T value = r->load(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    /**
+     * @brief Checks if the deque is empty.
+     *
+     * The result is a snapshot that may be outdated by the time it is used.
+     *
+     * @return True if the deque is empty, false otherwise.
+     */
+    bool is_empty() const {
+        return get_size() == 0;
+    }
+
+    /**
+     * @brief Returns the approximate number of elements in the deque.
+     *
+     * @return The current size, as a snapshot.
+     */
+    std::size_t get_size() const {
+        const std::int64_t b = bottom.load(std::memory_order_acquire);
+        const std::int64_t t = top.load(std::memory_order_acquire);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+    /**
+     * @brief Returns the capacity of the current ring.
+     *
+     * @return The number of elements the deque holds before it grows next (a power of two).
+     */
+    std::size_t get_capacity() const {
+        return active.load(std::memory_order_acquire)->mask + 1;
+    }
+
+private:
+
+    /**
+     * @brief Copies the live elements into a ring of twice the size and publishes it. Owner only.
+     *
+     * @param old The current ring.
+     * @param t The top position observed by the push.
+     * @param b The bottom position.
+     * @return The new ring.
+     */
+    ring *grow(ring *old, std::int64_t t, std::int64_t b) {
+        if (old->mask + 1 > (static_cast<std::size_t>(-1) >> 1) / sizeof(std::atomic<T>)) {
+            CQUEUE_THROW(std::length_error("Queue capacity is too large."));
+        }
+        rings.reserve(rings.size() + 1);
+        std::unique_ptr<ring> bigger(new ring(2 * (old->mask + 1)));
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->store(i, old->load(i));
+        }
+        ring *r = bigger.get();
+        rings.push_back(std::move(bigger));
+        active.store(r, std::memory_order_release);
+        return r;
+    }
+
+};
@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "async_queue.hpp"
+
+#if CQUEUE_HAS_COROUTINES
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief A coroutine that starts at once and frees itself when it finishes.
+     */
+    struct detached {
+        struct promise_type {
+            detached get_return_object() noexcept {
+                return {};
+            }
+
+            std::suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept {
+                return {};
+            }
+
+            void return_void() noexcept {
+            }
+
+            void unhandled_exception() noexcept {
+                std::terminate();
+            }
+        };
+    };
+
+    constexpr std::size_t producers = 2;
+    constexpr std::size_t per_producer = 20000;
+
+    /**
+     * @brief What the consumer saw, published with finished once it has every element.
+     */
+    struct consumer_result {
+        std::size_t sum{};
+        bool in_order{true};
+        std::atomic<bool> finished{false};
+    };
+
+    detached produce(async_queue<std::size_t> &queue, std::size_t producer, std::atomic<std::size_t> &done) {
+        for (std::size_t i = 0; i < per_producer; ++i) {
+            co_await queue.async_enqueue(producer * per_producer + i);
+        }
+        done.fetch_add(1, std::memory_order_release);
+    }
+
+    detached consume(async_queue<std::size_t> &queue, std::size_t count, consumer_result &result) {
+        std::size_t next[producers] = {};
+        for (std::size_t p = 0; p < producers; ++p) {
+            next[p] = p * per_producer;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t v = co_await queue.async_dequeue();
+            const std::size_t p = v / per_producer;
+            result.in_order = result.in_order && p < producers && v == next[p]++;
+            result.sum += v;
+        }
+        result.finished.store(true, std::memory_order_release);
+    }
+
+}
+
+int main() {
+    // One thread: the producer suspends once two elements are waiting, the consumer resumes it
+    {
+        async_queue<std::size_t> queue(2);
+        std::atomic<std::size_t> done{0};
+        produce(queue, 0, done);
+        check(done.load() == 0 && queue.get_size() == queue.get_capacity(), "producer suspends on a full queue");
+        consumer_result result;
+        consume(queue, per_producer, result);
+        check(done.load() == 1 && result.finished.load(), "consumer resumes the producer until both finish");
+        check(result.in_order, "elements arrive in order");
+        check(queue.is_empty(), "queue is empty at the end");
+    }
+
+    // Producer coroutines on two threads and a consumer started on this one; inline resumption moves
+    // each coroutine to whichever thread wakes it, so all of them are done once every thread has returned
+    {
+        async_queue<std::size_t> queue(4);
+        std::atomic<std::size_t> done{0};
+        consumer_result result;
+        consume(queue, producers * per_producer, result);
+        std::thread threads[producers];
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads[p] = std::thread([&queue, &done, p] { produce(queue, p, done); });
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+        const std::size_t total = producers * per_producer;
+        check(done.load(std::memory_order_acquire) == producers, "every producer finishes");
+        check(result.finished.load(std::memory_order_acquire), "the consumer finishes");
+        check(result.in_order, "each producer's elements arrive in order");
+        check(result.sum == total * (total - 1) / 2, "every element arrives once");
+        check(queue.is_empty(), "queue is empty at the end");
+    }
+
+    if (failures == 0) {
+        std::puts("async_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+int main() {
+    std::puts("async_queue: skipped, coroutines are not available");
+    return EXIT_SUCCESS;
+}
+
+#endif
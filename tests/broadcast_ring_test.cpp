@@ -0,0 +1,100 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "broadcast_ring.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t count = 100000;
+
+}
+
+int main() {
+    // Consumer 0 journals in place, consumer 1 copies, and consumer 2 depends on both
+    broadcast_ring<std::size_t, 3> ring(8);
+    ring.set_dependencies(2, {0, 1});
+    std::vector<unsigned char> journaled(count);
+    bool in_order[3] = {true, true, true};
+    bool after_journal = true;
+
+    std::thread journal([&] {
+        for (std::size_t expected = 0; expected < count;) {
+            const auto batch = ring.read_peek(0, 5);
+            const std::size_t n = batch.first.size() + batch.second.size();
+            for (std::size_t v : batch.first) {
+                in_order[0] = in_order[0] && v == expected++;
+                journaled[v % count] = 1;
+            }
+            for (std::size_t v : batch.second) {
+                in_order[0] = in_order[0] && v == expected++;
+                journaled[v % count] = 1;
+            }
+            if (n == 0) {
+                std::this_thread::yield();
+            } else {
+                ring.read_release(0, n);
+            }
+        }
+    });
+    std::thread copier([&] {
+        for (std::size_t expected = 0; expected < count;) {
+            std::size_t v = 0;
+            if (ring.try_dequeue(1, v)) {
+                in_order[1] = in_order[1] && v == expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread dependent([&] {
+        for (std::size_t expected = 0; expected < count;) {
+            std::size_t v = 0;
+            if (ring.try_dequeue(2, v)) {
+                in_order[2] = in_order[2] && v == expected++;
+                // What consumer 0 wrote before releasing the element is visible here
+                after_journal = after_journal && journaled[v % count] == 1;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (std::size_t v = 0; v < count; ++v) {
+        while (!ring.try_enqueue(v)) {
+            std::this_thread::yield();
+        }
+    }
+    journal.join();
+    copier.join();
+    dependent.join();
+
+    check(in_order[0], "the journaling consumer reads every element in order");
+    check(in_order[1], "the copying consumer reads every element in order");
+    check(in_order[2], "the dependent consumer reads every element in order");
+    check(after_journal, "the dependent consumer only sees journaled elements");
+    check(ring.is_empty(), "ring is empty once every consumer is done");
+
+    // The producer waits for the slowest consumer
+    broadcast_ring<int, 2> small(2);
+    check(small.try_enqueue(1) && small.try_enqueue(2) && !small.try_enqueue(3), "ring is full after one lap");
+    int v = 0;
+    check(small.try_dequeue(0, v) && v == 1 && !small.try_enqueue(3), "a fast consumer does not free a slot");
+    check(small.try_dequeue(1, v) && v == 1 && small.try_enqueue(3), "the slowest consumer frees the slot");
+
+    if (failures == 0) {
+        std::puts("broadcast_ring: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
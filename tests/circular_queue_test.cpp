@@ -0,0 +1,140 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "circular_queue.hpp"
+#include "queue_snapshot.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief Checks that a queue holds exactly first, first + 1, ..., first + size - 1, front first.
+     */
+    template<typename Queue>
+    bool holds_run(const Queue &queue, int first, std::size_t size) {
+        if (queue.get_size() != size) {
+            return false;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            if (queue.get_element_at(i) != first + static_cast<int>(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void overflow_policies() {
+        // A capacity of 5 is not a power of two, so the full check cannot rely on the slot mask
+        circular_queue<int> overwrite(5);
+        for (int v = 1; v <= 8; ++v) {
+            check(overwrite.enqueue(v), "overwrite_oldest always stores the element");
+        }
+        check(holds_run(overwrite, 4, 5) && overwrite.get_dropped_count() == 3, "overwrite_oldest keeps the newest");
+        const int range[] = {9, 10, 11, 12, 13, 14, 15};
+        check(overwrite.enqueue_bulk(range, 7) == 7, "overwrite_oldest takes a whole bulk range");
+        check(holds_run(overwrite, 11, 5) && overwrite.get_dropped_count() == 10, "bulk range longer than the queue");
+
+        circular_queue<int, no_log, reject_newest> reject(5);
+        check(reject.enqueue_bulk(range, 7) == 5 && holds_run(reject, 9, 5), "reject_newest stores what fits");
+        check(!reject.enqueue(16) && reject.get_dropped_count() == 0, "reject_newest refuses without counting");
+
+        circular_queue<int, no_log, drop_newest> drop(5);
+        check(drop.enqueue_bulk(range, 7) == 5 && holds_run(drop, 9, 5), "drop_newest stores what fits");
+        check(!drop.enqueue(16) && drop.get_dropped_count() == 3, "drop_newest counts what it discards");
+
+        circular_queue<int, no_log, throw_on_overflow> strict(5);
+        check(strict.enqueue_bulk(range, 5) == 5, "throw_on_overflow stores a range that fits");
+        bool thrown = false;
+        try {
+            strict.enqueue(16);
+        } catch (const std::overflow_error &) {
+            thrown = true;
+        }
+        check(thrown && holds_run(strict, 9, 5), "throw_on_overflow throws and keeps the queue");
+        thrown = false;
+        try {
+            strict.dequeue();
+            strict.enqueue_bulk(range, 2);
+        } catch (const std::overflow_error &) {
+            thrown = true;
+        }
+        check(thrown && holds_run(strict, 10, 4), "throw_on_overflow stores nothing of a range that does not fit");
+    }
+
+    void snapshots() {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            check(false, "create a pipe");
+            return;
+        }
+
+        // Wrapped contents are written as two chunks and restored into one run
+        circular_queue<int> source(8);
+        for (int v = 1; v <= 11; ++v) {
+            source.enqueue(v);
+        }
+        source.snapshot(fd_writer{fds[1]});
+        check(holds_run(source, 4, 8), "snapshot leaves the queue unchanged");
+        circular_queue<int> target(16);
+        target.enqueue(100);
+        target.restore(fd_reader{fds[0]});
+        check(holds_run(target, 4, 8), "restore replaces the contents with the snapshot");
+
+        // A snapshot that does not fit is refused before anything is read past its header
+        source.snapshot(fd_writer{fds[1]});
+        circular_queue<int> small(4);
+        small.enqueue(1);
+        bool thrown = false;
+        try {
+            small.restore(fd_reader{fds[0]});
+        } catch (const std::length_error &) {
+            thrown = true;
+        }
+        check(thrown && holds_run(small, 1, 1), "restore into a smaller queue is refused");
+        int skipped[8];
+        check(read(fds[0], skipped, sizeof(skipped)) == static_cast<ssize_t>(sizeof(skipped)),
+              "skip the refused elements");
+
+        // drain_to writes the bare elements and frees their slots
+        check(drain_to(source, fds[1]) == 8 && source.is_empty(), "drain_to removes every element");
+        int drained[8] = {};
+        check(read(fds[0], drained, sizeof(drained)) == static_cast<ssize_t>(sizeof(drained)) &&
+              drained[0] == 4 && drained[7] == 11, "drain_to writes the elements front first");
+
+        // Bare elements, cut off before a whole header, are not a snapshot
+        source.enqueue(1);
+        drain_to(source, fds[1]);
+        close(fds[1]);
+        thrown = false;
+        try {
+            target.restore(fd_reader{fds[0]});
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        check(thrown && holds_run(target, 4, 8), "restore refuses data that is not a snapshot");
+        close(fds[0]);
+    }
+
+}
+
+int main() {
+    overflow_policies();
+    snapshots();
+
+    if (failures == 0) {
+        std::puts("circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "mpmc_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t producers = 3;
+    constexpr std::size_t consumers = 2;
+    constexpr std::size_t per_producer = 40000;
+    constexpr std::size_t batch = 5;    ///< Largest batch handed to enqueue and dequeue
+
+    /**
+     * @brief What one consumer saw: the sum of the values, and whether each producer's values arrived in order.
+     */
+    struct consumer_result {
+        std::size_t sum{};
+        std::size_t received{};
+        bool in_order{true};
+    };
+
+    /**
+     * @brief Several producers and consumers share a small queue; the values are producer * per_producer + sequence.
+     *
+     * Every value must be received exactly once, and since each producer adds
+     * its values in order and the queue is FIFO, every consumer must see the
+     * values of each producer in increasing order. enqueue and dequeue take a
+     * batch of at most batch values and return how many they moved.
+     */
+    template<typename Enqueue, typename Dequeue>
+    void transfer(const char *what, Enqueue enqueue, Dequeue dequeue) {
+        std::atomic<std::size_t> remaining{producers * per_producer};
+        std::vector<std::thread> threads;
+        std::vector<consumer_result> results(consumers);
+
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([p, &enqueue] {
+                std::size_t values[batch];
+                for (std::size_t i = 0; i < per_producer;) {
+                    std::size_t n = 0;
+                    while (n < batch && i + n < per_producer) {
+                        values[n] = p * per_producer + i + n;
+                        ++n;
+                    }
+                    const std::size_t added = enqueue(values, n);
+                    i += added;
+                    if (added == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&remaining, &dequeue, &results, c] {
+                std::size_t last[producers];
+                bool seen[producers] = {};
+                consumer_result &result = results[c];
+                while (remaining.load(std::memory_order_relaxed) != 0) {
+                    std::size_t values[batch];
+                    const std::size_t n = dequeue(values, batch);
+                    if (n == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    remaining.fetch_sub(n, std::memory_order_relaxed);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        const std::size_t v = values[i];
+                        const std::size_t p = v / per_producer;
+                        result.in_order = result.in_order && p < producers && (!seen[p] || v > last[p]);
+                        if (p < producers) {
+                            last[p] = v;
+                            seen[p] = true;
+                        }
+                        result.sum += v;
+                        ++result.received;
+                    }
+                }
+            });
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+
+        const std::size_t total = producers * per_producer;
+        std::size_t sum = 0, received = 0;
+        bool in_order = true;
+        for (const consumer_result &result : results) {
+            sum += result.sum;
+            received += result.received;
+            in_order = in_order && result.in_order;
+        }
+        check(received == total, what);
+        check(sum == total * (total - 1) / 2, what);
+        check(in_order, what);
+    }
+
+}
+
+int main() {
+    mpmc_circular_queue<std::size_t> queue(8);
+    transfer("single operations",
+             [&queue](const std::size_t *values, std::size_t) { return queue.try_enqueue(values[0]) ? 1 : 0; },
+             [&queue](std::size_t *values, std::size_t) { return queue.try_dequeue(values[0]) ? 1 : 0; });
+    check(queue.is_empty(), "queue is empty after single operations");
+
+    // Batches of up to 5 in a queue of 8 often fit only in part and wrap around
+    transfer("bulk operations",
+             [&queue](const std::size_t *values, std::size_t n) { return queue.try_enqueue_bulk(values, n); },
+             [&queue](std::size_t *values, std::size_t max) { return queue.try_dequeue_bulk(values, max); });
+    check(queue.is_empty(), "queue is empty after bulk operations");
+
+    mpmc_circular_queue<std::size_t, true> blocking(4);
+    transfer("blocking operations",
+             [&blocking](const std::size_t *values, std::size_t) {
+                 return blocking.wait_enqueue(values[0], std::chrono::seconds(10)) ? 1 : 0;
+             },
+             [&blocking](std::size_t *values, std::size_t) {
+                 return blocking.wait_dequeue(values[0], std::chrono::milliseconds(1)) ? 1 : 0;
+             });
+    check(blocking.is_empty(), "blocking queue is empty at the end");
+
+    if (failures == 0) {
+        std::puts("mpmc_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "persistent_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief Fills a queue so that its elements wrap around, closes it, and checks what a reopened queue holds.
+     */
+    void reopen(const std::string &path, durability mode) {
+        unlink(path.c_str());
+        {
+            persistent_circular_queue<std::uint64_t> queue(path, 8, mode);
+            check(!queue.was_recovered(), "a new file is not recovered");
+            for (std::uint64_t v = 1; v <= 6; ++v) {
+                queue.enqueue(v);
+            }
+            check(queue.dequeue() == 1 && queue.dequeue() == 2 && queue.dequeue() == 3, "dequeue before reopening");
+            const std::uint64_t more[] = {7, 8, 9, 10, 11};
+            check(queue.enqueue_bulk(more, 5) == 5, "bulk enqueue across the wrap point");
+            check(!queue.enqueue(12), "enqueue into a full queue fails");
+        }
+        {
+            // The capacity comes from the file, not from the argument
+            persistent_circular_queue<std::uint64_t> queue(path, 100, mode);
+            check(queue.was_recovered(), "an existing queue is recovered");
+            check(queue.get_capacity() == 8 && queue.get_size() == 8, "capacity and size survive reopening");
+            std::uint64_t values[8] = {};
+            check(queue.dequeue_bulk(values, 5) == 5, "bulk dequeue after reopening");
+            bool in_order = true;
+            for (std::uint64_t i = 0; i < 5; ++i) {
+                in_order = in_order && values[i] == i + 4;
+            }
+            check(in_order, "elements survive reopening in order");
+            queue.enqueue(12);
+        }
+        {
+            persistent_circular_queue<std::uint64_t> queue(path, 8, mode);
+            check(queue.get_size() == 4 && queue.peek() == 9, "a second reopening sees the dequeues");
+            check(queue.dequeue() == 9 && queue.dequeue() == 10 && queue.dequeue() == 11 && queue.dequeue() == 12,
+                  "elements added after the first reopening");
+            check(queue.is_empty(), "queue is empty at the end");
+        }
+        unlink(path.c_str());
+    }
+
+}
+
+int main() {
+    const std::string path = "persistent_circular_queue_test." + std::to_string(static_cast<long>(getpid()));
+    reopen(path, durability::none);
+    reopen(path, durability::per_batch);
+    reopen(path, durability::per_op);
+
+    {
+        persistent_circular_queue<std::uint64_t> queue(path, 8);
+        bool locked = false;
+        try {
+            persistent_circular_queue<std::uint64_t> second(path, 8);
+        } catch (const std::system_error &) {
+            locked = true;
+        }
+        check(locked, "a queue file is opened by one queue at a time");
+    }
+
+    bool refused = false;
+    try {
+        persistent_circular_queue<std::uint32_t> other(path, 8);
+    } catch (const std::runtime_error &) {
+        refused = true;
+    }
+    check(refused, "a queue of another element size is refused");
+    unlink(path.c_str());
+
+    // A file that is not a queue is left alone
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    const char text[] = "not a queue";
+    check(file != nullptr && std::fwrite(text, 1, sizeof(text), file) == sizeof(text), "write a text file");
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+    refused = false;
+    try {
+        persistent_circular_queue<std::uint64_t> queue(path, 8);
+    } catch (const std::runtime_error &) {
+        refused = true;
+    }
+    char read_back[sizeof(text)] = {};
+    file = std::fopen(path.c_str(), "r");
+    check(file != nullptr && std::fread(read_back, 1, sizeof(read_back), file) == sizeof(text) &&
+          std::memcmp(read_back, text, sizeof(text)) == 0, "the text file is unchanged");
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+    check(refused, "a file that is not a queue is refused");
+    unlink(path.c_str());
+
+    if (failures == 0) {
+        std::puts("persistent_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "sharded_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t producers = 3;
+    constexpr std::size_t consumers = 2;
+    constexpr std::size_t per_producer = 40000;
+
+    /**
+     * @brief Producers and consumers on their own thread slots share two small shards.
+     *
+     * Order holds only within a shard, so the check is that every value is
+     * received exactly once, whether it was drained locally, stolen, or
+     * spilled to the other shard.
+     */
+    void transfer() {
+        sharded_circular_queue<std::size_t> queue(4, 2);
+        const std::size_t total = producers * per_producer;
+        std::atomic<std::size_t> remaining{total};
+        std::vector<std::vector<std::size_t>> received(consumers);
+
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, p] {
+                sharded_circular_queue<std::size_t>::bind_thread_slot(p);
+                for (std::size_t i = 0; i < per_producer; ++i) {
+                    while (!queue.try_enqueue(p * per_producer + i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&queue, &remaining, &received, c] {
+                sharded_circular_queue<std::size_t>::bind_thread_slot(c);
+                std::size_t values[3];
+                while (remaining.load(std::memory_order_relaxed) != 0) {
+                    // Alternate single and bulk dequeues
+                    std::size_t n = received[c].size() % 2 == 0 ? queue.try_dequeue_bulk(values, 3)
+                                                                : (queue.try_dequeue(values[0]) ? 1 : 0);
+                    if (n == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    remaining.fetch_sub(n, std::memory_order_relaxed);
+                    received[c].insert(received[c].end(), values, values + n);
+                }
+            });
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+
+        std::vector<unsigned char> seen(total);
+        bool once = true;
+        std::size_t sum = 0;
+        for (const std::vector<std::size_t> &values : received) {
+            for (std::size_t v : values) {
+                once = once && v < total && seen[v]++ == 0;
+                sum += v;
+            }
+        }
+        check(once, "every element is received exactly once");
+        check(sum == total * (total - 1) / 2, "sum of the received elements");
+        check(queue.is_empty(), "queue is empty at the end");
+    }
+
+}
+
+int main() {
+    transfer();
+
+    // A full local shard spills to the next one; the queue fails only when every shard is full
+    sharded_circular_queue<int> queue(2, 2);
+    sharded_circular_queue<int>::bind_thread_slot(0);
+    for (int v = 1; v <= 4; ++v) {
+        check(queue.try_enqueue(v), "enqueue while a shard has room");
+    }
+    check(!queue.try_enqueue(5), "enqueue into a full queue fails");
+    check(queue.get_size(0) == 2 && queue.get_size(1) == 2, "spilled elements land in the other shard");
+    int v = 0;
+    check(queue.try_dequeue(v) && v == 1, "the local shard is drained first, in order");
+
+    if (failures == 0) {
+        std::puts("sharded_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shm_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t per_producer = 50000;
+
+    /**
+     * @brief Attaches to the queue by name and adds producer * per_producer + sequence for every sequence.
+     */
+    void produce(const std::string &name, std::size_t producer) {
+        shm_circular_queue<std::size_t> queue(name);
+        for (std::size_t i = 0; i < per_producer; ++i) {
+            while (!queue.try_enqueue(producer * per_producer + i)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+}
+
+int main() {
+    const std::string name = "/cqueue_test_" + std::to_string(static_cast<long>(getpid()));
+    shm_circular_queue<std::size_t> queue(name, 8);
+
+    // Producer 0 is a child process and producer 1 a thread with its own mapping
+    const pid_t child = fork();
+    if (child == 0) {
+        produce(name, 0);
+        _exit(EXIT_SUCCESS);   // Skips the parent's queue, whose destructor would remove the name
+    }
+    check(child > 0, "fork a producer process");
+    std::thread producer([&name] { produce(name, 1); });
+
+    const std::size_t producers = child > 0 ? 2 : 1;
+    std::size_t next[2] = {0, per_producer};
+    bool in_order = true;
+    std::size_t sum = 0;
+    for (std::size_t received = 0; received < producers * per_producer;) {
+        std::size_t v = 0;
+        if (!queue.try_dequeue(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::size_t p = v / per_producer;
+        in_order = in_order && p < 2 && v == next[p]++;
+        sum += v;
+        ++received;
+    }
+    producer.join();
+
+    int status = 0;
+    check(child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+          WEXITSTATUS(status) == EXIT_SUCCESS, "producer process exits cleanly");
+    check(in_order, "each producer's elements arrive in order");
+    const std::size_t total = 2 * per_producer;
+    check(sum == total * (total - 1) / 2, "every element arrives once");
+    check(queue.is_empty(), "queue is empty at the end");
+
+    // An attached queue shares the elements of the creator
+    shm_circular_queue<std::size_t> attached(name);
+    check(queue.try_enqueue(7), "enqueue through the creator");
+    std::size_t v = 0;
+    check(attached.try_dequeue(v) && v == 7, "dequeue through an attached queue");
+
+    if (failures == 0) {
+        std::puts("shm_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
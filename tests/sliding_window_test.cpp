@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+#include "ring_reductions.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what, std::size_t window, std::size_t step) {
+        if (!condition) {
+            std::printf("FAIL: %s (window %zu, push %zu)\n", what, window, step);
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief Pushes a sequence into a window of n values and compares every aggregate with a brute-force deque.
+     */
+    template<typename Generator>
+    void compare_with_reference(std::size_t n, std::size_t count, Generator next) {
+        sliding_window<int> window(n);
+        std::deque<int> reference;
+        for (std::size_t i = 0; i < count; ++i) {
+            const int value = next(i);
+            window.push(value);
+            reference.push_back(value);
+            if (reference.size() > n) {
+                reference.pop_front();
+            }
+            check(window.min() == *std::min_element(reference.begin(), reference.end()), "min", n, i);
+            check(window.max() == *std::max_element(reference.begin(), reference.end()), "max", n, i);
+            int sum = 0;
+            for (int v : reference) {
+                sum += v;
+            }
+            check(window.sum() == sum, "sum", n, i);
+        }
+    }
+
+}
+
+int main() {
+    // Power-of-two and other window sizes; a full window must not overwrite its oldest candidate
+    const std::size_t sizes[] = {1, 2, 3, 4, 5, 7, 8, 16, 17};
+    for (std::size_t n : sizes) {
+        compare_with_reference(n, 4 * n + 3, [](std::size_t i) { return static_cast<int>(i) + 1; });
+        compare_with_reference(n, 4 * n + 3, [](std::size_t i) { return 100 - static_cast<int>(i); });
+        std::srand(static_cast<unsigned>(n));
+        compare_with_reference(n, 64 * n, [](std::size_t) { return std::rand() % 50; });
+    }
+
+    sliding_window<int> window(4);
+    for (int v = 1; v <= 5; ++v) {
+        window.push(v);
+    }
+    check(window.min() == 2 && window.max() == 5, "min and max of 1..5 in a window of 4", 4, 5);
+    window.evict(2);
+    check(window.min() == 4 && window.max() == 5 && window.sum() == 9, "min, max and sum after evict(2)", 4, 5);
+
+    if (failures == 0) {
+        std::puts("sliding_window: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
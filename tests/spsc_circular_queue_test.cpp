@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "spsc_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t count = 100000;
+
+    /**
+     * @brief Moves 1..count through a small queue with one producer thread and checks order and sum on the consumer.
+     */
+    void single_operations() {
+        spsc_circular_queue<std::size_t> queue(8);
+        std::thread producer([&queue] {
+            for (std::size_t v = 1; v <= count; ++v) {
+                while (!queue.try_enqueue(v)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        bool in_order = true;
+        std::size_t sum = 0;
+        for (std::size_t expected = 1; expected <= count;) {
+            std::size_t v = 0;
+            if (!queue.try_dequeue(v)) {
+                std::this_thread::yield();
+                continue;
+            }
+            in_order = in_order && v == expected;
+            sum += v;
+            ++expected;
+        }
+        producer.join();
+        check(in_order, "single operations keep FIFO order");
+        check(sum == count * (count + 1) / 2, "single operations deliver every element once");
+        check(queue.is_empty(), "queue is empty after single operations");
+    }
+
+    /**
+     * @brief The same transfer with bulk operations of uneven sizes, so batches straddle the wrap point.
+     */
+    void bulk_operations() {
+        spsc_circular_queue<std::size_t> queue(16);
+        std::thread producer([&queue] {
+            std::size_t batch[7];
+            for (std::size_t next = 1; next <= count;) {
+                std::size_t n = 0;
+                while (n < 7 && next + n <= count) {
+                    batch[n] = next + n;
+                    ++n;
+                }
+                const std::size_t added = queue.try_enqueue_bulk(batch, n);
+                next += added;
+                if (added == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        bool in_order = true;
+        std::size_t expected = 1;
+        while (expected <= count) {
+            std::size_t batch[5];
+            const std::size_t n = queue.try_dequeue_bulk(batch, 5);
+            for (std::size_t i = 0; i < n; ++i) {
+                in_order = in_order && batch[i] == expected++;
+            }
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        check(in_order, "bulk operations keep FIFO order");
+        check(queue.is_empty(), "queue is empty after bulk operations");
+    }
+
+    /**
+     * @brief The blocking waits: the consumer parks on an empty queue and the producer on a full one.
+     */
+    void blocking_operations() {
+        spsc_circular_queue<std::size_t, true> queue(4);
+        std::thread producer([&queue] {
+            for (std::size_t v = 1; v <= count; ++v) {
+                queue.wait_enqueue(v, std::chrono::seconds(10));
+            }
+        });
+
+        bool in_order = true;
+        std::size_t received = 0;
+        for (std::size_t expected = 1; expected <= count; ++expected) {
+            std::size_t v = 0;
+            if (!queue.wait_dequeue(v, std::chrono::seconds(10))) {
+                break;
+            }
+            in_order = in_order && v == expected;
+            ++received;
+        }
+        producer.join();
+        check(received == count, "blocking dequeue receives every element");
+        check(in_order, "blocking operations keep FIFO order");
+    }
+
+}
+
+int main() {
+    single_operations();
+    bulk_operations();
+    blocking_operations();
+
+    if (failures == 0) {
+        std::puts("spsc_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "timed_circular_queue.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+}
+
+int main() {
+    using clock = std::chrono::steady_clock;
+    using std::chrono::seconds;
+
+    // Window of 4, fed 1..5 at 1s..5s: the push of 5 overwrites 1
+    timed_circular_queue<int, clock, true> queue(4);
+    for (int v = 1; v <= 5; ++v) {
+        queue.push(v, clock::time_point(seconds(v)));
+    }
+    check(queue.get_size() == 4, "size after overwrite");
+    check(queue.min() == 2, "min after overwrite");
+    check(queue.max() == 5, "max after overwrite");
+    check(queue.sum() == 14, "sum after overwrite");
+
+    check(queue.evict_older_than(clock::time_point(seconds(4))) == 2, "evicted count");
+    check(queue.min() == 4, "min after eviction");
+    check(queue.max() == 5, "max after eviction");
+    check(queue.sum() == 9, "sum after eviction");
+
+    // Decreasing values exercise the maximum candidates the same way
+    timed_circular_queue<int, clock, true> falling(4);
+    for (int v = 8; v >= 1; --v) {
+        falling.push(v, clock::time_point(seconds(9 - v)));
+        if (v == 5) {
+            check(falling.max() == 8 && falling.min() == 5, "min and max when the window first fills");
+        }
+    }
+    check(falling.max() == 4 && falling.min() == 1, "min and max after overwrites");
+    falling.evict_older_than(clock::time_point(seconds(7)));
+    check(falling.max() == 2 && falling.min() == 1, "min and max after eviction");
+
+    if (failures == 0) {
+        std::puts("timed_circular_queue: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_deque.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    constexpr std::size_t count = 100000;
+    constexpr std::size_t thieves = 2;
+
+    /**
+     * @brief The owner pushes 0..count-1 into a deque that starts with two slots while thieves steal from it.
+     *
+     * With interleaved pops, every value must still be taken exactly once, by
+     * the owner or by one thief. In the push-only phase, each thief must also
+     * see the values in the order they were pushed, since it takes the oldest.
+     *
+     * @param pop_every The owner pops after every pop_every pushes; 0 never pops until the end.
+     */
+    void share(const char *what, std::size_t pop_every) {
+        work_stealing_deque<std::size_t> deque(2);
+        std::atomic<std::size_t> taken{0};
+        std::vector<std::vector<std::size_t>> stolen(thieves);
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < thieves; ++i) {
+            threads.emplace_back([&deque, &taken, &stolen, i] {
+                while (taken.load(std::memory_order_relaxed) != count) {
+                    std::size_t v = 0;
+                    if (deque.try_steal(v)) {
+                        stolen[i].push_back(v);
+                        taken.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<std::size_t> popped;
+        for (std::size_t v = 0; v < count; ++v) {
+            deque.push(v);
+            std::size_t out = 0;
+            if (pop_every != 0 && v % pop_every == 0 && deque.try_pop(out)) {
+                popped.push_back(out);
+                taken.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (v % 64 == 0) {
+                std::this_thread::yield();  // Lets the thieves run on a machine with few cores
+            }
+        }
+        std::size_t out = 0;
+        while (taken.load(std::memory_order_relaxed) != count) {
+            if (deque.try_pop(out)) {
+                popped.push_back(out);
+                taken.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+
+        std::vector<unsigned char> seen(count);
+        bool once = true;
+        bool steals_in_order = true;
+        for (const std::vector<std::size_t> &values : stolen) {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                once = once && values[i] < count && seen[values[i]]++ == 0;
+                steals_in_order = steals_in_order && (i == 0 || values[i] > values[i - 1]);
+            }
+        }
+        for (std::size_t v : popped) {
+            once = once && v < count && seen[v]++ == 0;
+        }
+        check(once, what);
+        check(deque.is_empty(), what);
+        if (pop_every == 0) {
+            check(steals_in_order, "thieves take the oldest elements first");
+        }
+    }
+
+}
+
+int main() {
+    share("push only, then drain", 0);
+    share("interleaved push and pop", 3);
+
+    // The owner alone works LIFO
+    work_stealing_deque<std::size_t> deque(2);
+    for (std::size_t v = 1; v <= 5; ++v) {
+        deque.push(v);
+    }
+    std::size_t v = 0;
+    check(deque.try_pop(v) && v == 5, "pop takes the newest element");
+    check(deque.try_steal(v) && v == 1, "steal takes the oldest element");
+    check(deque.get_size() == 3 && deque.get_capacity() >= 5, "size and grown capacity");
+
+    if (failures == 0) {
+        std::puts("work_stealing_deque: all checks passed");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}